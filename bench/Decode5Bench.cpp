@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#include "kawashima/hca/internal/CCpuFeatures.h"
+#include "kawashima/hca/internal/CHcaChannel.h"
+
+// Times CHcaChannel::Decode5() with each kernel the CPU supports, and checks that every kernel
+// gives the same samples as the scalar one.
+// Usage: acb-bench-decode5 [block count]
+
+using namespace acb;
+
+using Decode5Kernel = CHcaChannel::Decode5Kernel;
+
+struct KernelInfo {
+    Decode5Kernel kernel;
+    const char *name;
+    bool_t supported;
+};
+
+static constexpr std::uint32_t DefaultBlockCount = 0x4000;
+static constexpr std::uint32_t RepeatCount       = 5;
+
+using Spectra = std::array<std::array<float, 0x80>, 8>;
+
+// Reproducible spectra of the 8 sub-blocks of a block, with values in [-1, 1).
+static auto CreateSpectra() -> Spectra {
+    Spectra spectra    = {};
+    std::uint32_t seed = 1;
+    for (auto &spectrum : spectra) {
+        for (auto &f : spectrum) {
+            seed = seed * 1664525u + 1013904223u;
+            f    = static_cast<float>(seed >> 8u) / static_cast<float>(1u << 23u) - 1.0f;
+        }
+    }
+    return spectra;
+}
+
+static const Spectra InputSpectra = CreateSpectra();
+
+// Decodes blockCount blocks of 8 sub-blocks, and returns the best time of RepeatCount runs in
+// nanoseconds per Decode5() call.
+static auto TimeKernel(Decode5Kernel kernel, CHcaChannel *channel, std::uint32_t blockCount)
+    -> double {
+    auto best = 0.0;
+    for (std::uint32_t r = 0; r < RepeatCount; ++r) {
+        channel->Clear();
+        const auto start = std::chrono::steady_clock::now();
+        for (std::uint32_t i = 0; i < blockCount; ++i) {
+            for (auto j = 0; j < 8; ++j) {
+                // Decode5 overwrites block, so give it the input again each time.
+                channel->block = InputSpectra[j];
+                CHcaChannel::Decode5Using(kernel, channel, j);
+            }
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start
+        );
+        const auto perCall = elapsed.count() / (blockCount * 8.0);
+        best               = r == 0 ? perCall : std::min(best, perCall);
+    }
+    return best;
+}
+
+// Largest difference from the scalar kernel over a few blocks, starting from a cleared channel.
+static auto CompareWithScalar(Decode5Kernel kernel, CHcaChannel *channel, CHcaChannel *reference)
+    -> float {
+    auto maxDiff = 0.0f;
+    channel->Clear();
+    reference->Clear();
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        for (auto j = 0; j < 8; ++j) {
+            channel->block   = InputSpectra[j];
+            reference->block = InputSpectra[j];
+            CHcaChannel::Decode5Using(kernel, channel, j);
+            CHcaChannel::Decode5Using(Decode5Kernel::Scalar, reference, j);
+        }
+        for (auto j = 0; j < 8; ++j) {
+            for (std::size_t k = 0; k < channel->wave[j].size(); ++k) {
+                const auto diff = std::fabs(channel->wave[j][k] - reference->wave[j][k]);
+                maxDiff         = std::max(maxDiff, diff);
+            }
+        }
+    }
+    return maxDiff;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto blockCount = DefaultBlockCount;
+    if (argc > 1) {
+        blockCount = static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 0));
+    }
+    if (blockCount == 0) {
+        std::fprintf(stderr, "Usage: %s [block count]\n", argv[0]);
+        return 1;
+    }
+
+    const std::array<KernelInfo, 3> kernels = {{
+        {Decode5Kernel::Scalar, "scalar", TRUE},
+        {Decode5Kernel::Sse2, "sse2", CCpuFeatures::HasSse2()},
+        {Decode5Kernel::Avx2, "avx2", CCpuFeatures::HasAvx2()},
+    }};
+
+    auto channel   = new CHcaChannel();
+    auto reference = new CHcaChannel();
+
+    std::printf("Decode5, %u blocks, best of %u runs\n", blockCount, RepeatCount);
+    auto scalarTime = 0.0;
+    for (const auto &info : kernels) {
+        if (!info.supported) {
+            std::printf("%-8s not supported by this CPU\n", info.name);
+            continue;
+        }
+        const auto time = TimeKernel(info.kernel, channel, blockCount);
+        if (info.kernel == Decode5Kernel::Scalar) {
+            scalarTime = time;
+        }
+        const auto maxDiff = CompareWithScalar(info.kernel, channel, reference);
+        std::printf(
+            "%-8s %8.1f ns/call  %5.2fx  max diff %g\n",
+            info.name,
+            time,
+            scalarTime / time,
+            static_cast<double>(maxDiff)
+        );
+    }
+
+    delete reference;
+    delete channel;
+    return 0;
+}
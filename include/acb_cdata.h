@@ -79,6 +79,49 @@ struct HCA_DECODER_CONFIG {
     bool_t loopEnabled;
     std::uint32_t loopCount;
     HcaDecodeFunc decodeFunc;
+    /**
+     * Maximum number of decoded blocks kept in the block cache. 0 means no limit.
+     */
+    std::uint32_t blockCacheCount;
+    /**
+     * Maximum number of bytes of decoded blocks kept in the block cache. 0 means no limit. The
+     * cache always holds at least one block.
+     */
+    std::uint64_t blockCacheSize;
+    /**
+     * Whether forward-only streaming is enabled. Decoded blocks are not cached in this mode: each
+     * block is decoded into one reusable buffer, or directly into the buffer passed to Read() when
+     * a whole block fits in it. Memory usage stays constant regardless of the audio length.
+     */
+    bool_t streamingEnabled;
+    /**
+     * Number of blocks decoded ahead of the read position by a background thread. 0 disables
+     * prefetching. When enabled, Read() only copies blocks that are already decoded, unless the
+     * position jumps outside of the prefetched range. The block cache and streaming mode are not
+     * used in this mode.
+     */
+    std::uint32_t prefetchBlockCount;
+    /**
+     * Output sample format. Any value other than HcaWaveFormat::Default overrides decodeFunc, and
+     * samples are converted by built-in block converters instead.
+     */
+    HcaWaveFormat waveFormat;
+    /**
+     * Which blocks have their checksum verified when they are read. Blocks failing it throw
+     * OpResult::ChecksumError.
+     */
+    HcaChecksumPolicy checksumPolicy;
+    /**
+     * Parameter of checksumPolicy: the number of blocks verified for
+     * HcaChecksumPolicy::FirstBlocks, or the sampling interval for HcaChecksumPolicy::Sampled,
+     * where 0 stands for 1.
+     */
+    std::uint32_t checksumBlockCount;
+    /**
+     * Decoding quality. With HcaDecodeQuality::PreviewHalfRate, blocks hold 0x200 frames instead of
+     * 0x400, and the wave header, sample counts and positions all use half the sampling rate.
+     */
+    HcaDecodeQuality decodeQuality;
 };
 
 struct HCA_INFO {
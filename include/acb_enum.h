@@ -21,6 +21,64 @@ enum class HcaCipherType : std::uint32_t {
     WithKey  = 56,
 };
 
+/**
+ * Sample format of decoded HCA wave data.
+ */
+enum class HcaWaveFormat : std::uint32_t {
+    /**
+     * Use HCA_DECODER_CONFIG::decodeFunc. The format is derived from it when it is one of the
+     * CDefaultWaveGenerator functions, otherwise from WaveSettings::BitPerChannel.
+     */
+    Default = 0,
+    U8      = 1,
+    S16     = 2,
+    S24     = 3,
+    S32     = 4,
+    Float   = 5,
+};
+
+/**
+ * Which HCA blocks have their checksum verified while decoding.
+ */
+enum class HcaChecksumPolicy : std::uint32_t {
+    /**
+     * Every block.
+     */
+    Always = 0,
+    /**
+     * The first HCA_DECODER_CONFIG::checksumBlockCount blocks only.
+     */
+    FirstBlocks = 1,
+    /**
+     * One block out of HCA_DECODER_CONFIG::checksumBlockCount, starting with the first one.
+     */
+    Sampled = 2,
+    /**
+     * No block. Meant for files already verified, e.g. with CHcaDecoder::VerifyBlocks().
+     */
+    Never = 3,
+};
+
+/**
+ * Trade-off between decoding speed and fidelity of HCA decoding.
+ */
+enum class HcaDecodeQuality : std::uint32_t {
+    /**
+     * The exact output of the reference decoder.
+     */
+    Full = 0,
+    /**
+     * Skips the reconstruction of the high bands, which are left silent. Meant for previews and
+     * waveform displays.
+     */
+    Preview = 1,
+    /**
+     * Preview, and only the lower half of the spectrum is transformed back, giving half as many
+     * samples at half the sampling rate.
+     */
+    PreviewHalfRate = 2,
+};
+
 enum class UtfColumnType : std::uint8_t {
     U8     = 0,
     S8     = 1,
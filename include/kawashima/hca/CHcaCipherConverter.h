@@ -3,8 +3,10 @@
 
 #include <cstdint>
 #include <map>
+#include <string>
 
 #include "acb_cdata.h"
+#include "acb_enum.h"
 #include "acb_env.h"
 #include "acb_env_ns.h"
 
@@ -12,6 +14,8 @@
 
 ACB_NS_BEGIN
 
+class CAfs2Archive;
+class CHcaBlockRecipher;
 class CHcaCipher;
 
 class CHcaCipherConverter: public CHcaFormatReader {
@@ -30,6 +34,21 @@ public:
         IStream *stream, const HCA_CIPHER_CONFIG &cryptFrom, const HCA_CIPHER_CONFIG &cryptTo
     );
 
+    /**
+     * Creates a new HCA cipher converter.
+     * @param stream Source stream.
+     * @param cryptFrom Source cipher type.
+     * @param cryptTo Wanted cipher type.
+     * @param streamingEnabled Whether forward-only streaming is enabled. Converted blocks are not
+     * kept in this mode: each block is converted into one reusable buffer, or directly into the
+     * buffer passed to Read() when a whole block fits in it. Memory usage stays constant regardless
+     * of the data length.
+     */
+    ACB_EXPORT CHcaCipherConverter(
+        IStream *stream, const HCA_CIPHER_CONFIG &cryptFrom, const HCA_CIPHER_CONFIG &cryptTo,
+        bool_t streamingEnabled
+    );
+
     CHcaCipherConverter(const CHcaCipherConverter &) = delete;
 
     CHcaCipherConverter(CHcaCipherConverter &&) = delete;
@@ -50,18 +69,99 @@ public:
 
     ACB_EXPORT auto GetLength() -> std::uint64_t override;
 
+    /**
+     * Converts the cipher of an HCA file in memory, rewriting the CIPH header, and every block and
+     * checksum in place.
+     * @remarks All blocks are verified before anything is changed, so the data is left untouched
+     * if any of them is corrupted.
+     * @param data The HCA file.
+     * @param size Size of data. Trailing bytes after the last block are left untouched.
+     * @param cryptFrom Source cipher type.
+     * @param cryptTo Wanted cipher type.
+     */
+    ACB_EXPORT static void ConvertInPlace(
+        void *data, std::uint64_t size, const HCA_CIPHER_CONFIG &cryptFrom,
+        const HCA_CIPHER_CONFIG &cryptTo
+    );
+
+    /**
+     * Converts the cipher of an HCA file in place through a memory mapping, without copying it.
+     * @param fileName Path of the HCA file.
+     * @param cryptFrom Source cipher type.
+     * @param cryptTo Wanted cipher type.
+     */
+    ACB_EXPORT static void ConvertFileInPlace(
+        const std::string &fileName, const HCA_CIPHER_CONFIG &cryptFrom,
+        const HCA_CIPHER_CONFIG &cryptTo
+    );
+
+    /**
+     * Converts the cipher of an HCA file stored in an AFS2 archive in place, through a memory
+     * mapping of the entry only.
+     * @param fileName Path of the file the archive was read from, e.g. the AWB file.
+     * @param record Record of the entry, with offsets in that file.
+     * @param cryptFrom Source cipher type.
+     * @param cryptTo Wanted cipher type.
+     */
+    ACB_EXPORT static void ConvertFileInPlace(
+        const std::string &fileName, const AFS2_FILE_RECORD &record,
+        const HCA_CIPHER_CONFIG &cryptFrom, const HCA_CIPHER_CONFIG &cryptTo
+    );
+
+    /**
+     * Converts the cipher of every HCA file in an AFS2 archive in place, through a memory mapping
+     * of the archive file, on several threads.
+     * @remarks Files are split into ranges of blocks which are converted in parallel. Entries that
+     * do not start with the HCA magic are skipped. All headers and blocks are verified before
+     * anything is changed, so the archive is left untouched if any of them is corrupted, and a
+     * CFormatException naming the cue is thrown. Keys of archives usually depend on
+     * the key modifier of the archive, see CAfs2Archive::GetHcaKeyModifier().
+     * @param archive The archive. Its file, GetFileName(), must hold the record offsets.
+     * @param cryptFrom Source cipher type.
+     * @param cryptTo Wanted cipher type.
+     * @param threadCount Maximum number of threads, or 0 to use one per hardware thread.
+     */
+    ACB_EXPORT static void ConvertArchiveInPlace(
+        const CAfs2Archive &archive, const HCA_CIPHER_CONFIG &cryptFrom,
+        const HCA_CIPHER_CONFIG &cryptTo, std::uint32_t threadCount
+    );
+
 private:
     auto ConvertBlock(std::uint32_t blockIndex) -> const std::uint8_t *;
 
+    /**
+     * Reads and converts a block into the given buffer, bypassing any cache.
+     * @param blockIndex Index of the block.
+     * @param blockBuffer Destination buffer, at least blockSize bytes.
+     */
+    void ConvertBlockInto(std::uint32_t blockIndex, std::uint8_t *blockBuffer);
+
     auto ConvertHeader() -> const std::uint8_t *;
 
+    /**
+     * Sets the cipher type in the CIPH header, if any, and fixes the header checksum.
+     * @param headerBuffer The header, dataOffset bytes ending with its checksum.
+     * @param dataOffset Size of the header.
+     * @param cipherType The new cipher type.
+     */
+    static void RewriteHeader(
+        std::uint8_t *headerBuffer, std::uint32_t dataOffset, HcaCipherType cipherType
+    );
+
     void InitializeExtra();
 
-    CHcaCipher *_cipherFrom = nullptr;
-    CHcaCipher *_cipherTo   = nullptr;
+    static constexpr std::uint32_t InvalidBlockIndex = 0xffffffff;
+
+    CHcaCipher *_cipherFrom      = nullptr;
+    CHcaCipher *_cipherTo        = nullptr;
+    CHcaBlockRecipher *_recipher = nullptr;
     HCA_CIPHER_CONFIG _ccFrom, _ccTo;
     std::uint8_t *_headerBuffer;
     std::map<std::uint32_t, const std::uint8_t *> _blockBuffers;
+    bool_t _streamingEnabled;
+    // Streaming mode only: the block buffer that is reused for every converted block.
+    std::uint8_t *_streamBlockBuffer;
+    std::uint32_t _streamBlockIndex;
     std::uint64_t _position;
 };
 
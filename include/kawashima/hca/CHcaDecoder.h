@@ -1,9 +1,11 @@
 #ifndef ACB_KAWASHIMA_HCA_CHCADECODER_H_
 #define ACB_KAWASHIMA_HCA_CHCADECODER_H_
 
-#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <mutex>
+#include <vector>
 
 #include "acb_cdata.h"
 #include "acb_env.h"
@@ -15,8 +17,17 @@ ACB_NS_BEGIN
 
 class CHcaCipher;
 class CHcaAth;
-class CHcaChannel;
+class CHcaBlockCache;
+class CHcaBlockDecoder;
+class CHcaPrefetcher;
 
+/**
+ * Decodes an HCA file to wave data.
+ * @remarks Read(), DecodeBlocks() and DecodeBlocksPlanar() throw a CException with
+ * OpResult::DecodeFailed on a block whose delta-coded scale factors fall out of range, which only
+ * happens with corrupted data or a wrong key. Such blocks used to be decoded anyway, indexing past
+ * the scale factor tables. This applies to every block, whatever the HcaChecksumPolicy.
+ */
 class CHcaDecoder: public CHcaFormatReader {
 
     _extends(CHcaFormatReader, CHcaDecoder);
@@ -36,16 +47,111 @@ public:
 
     ACB_EXPORT ~CHcaDecoder() override;
 
+    /**
+     * Makes the decoder decode another HCA file, as if it was constructed again with these
+     * arguments, e.g. to pool decoders for many short files.
+     * @remarks The ATH table, the cipher, the channels and the buffers are reused. Channels and
+     * buffers are only reallocated when the channel count, the block size or the wave block size
+     * grows. The prefetch worker, if any, is stopped and started again. If this throws, the
+     * decoder must be reset successfully again before any other use.
+     * @param stream Source stream.
+     * @param decoderConfig Decoder config.
+     */
+    ACB_EXPORT void Reset(IStream *stream, const HCA_DECODER_CONFIG &decoderConfig);
+
     ACB_EXPORT auto Read(
         void *buffer, std::size_t bufferSize, std::size_t offset, std::size_t count
     ) -> std::size_t override;
 
     ACB_EXPORT auto GetPosition() -> std::uint64_t override;
 
+    /**
+     * Sets the stream position. In prefetch mode, the worker starts decoding from there right
+     * away.
+     * @remarks Never throws. A position that cannot be read, e.g. past the first loop when looping
+     * forever, makes Read() throw instead.
+     */
     ACB_EXPORT void SetPosition(std::uint64_t value) override;
 
+    /**
+     * Moves the stream position to the start of a sample frame of the wave output.
+     * @remarks Nothing is decoded here. The next Read() decodes the block holding the frame, after
+     * the block before it, usually just one, to rebuild the state carried between blocks. Reads
+     * then continue sequentially, so a seek costs the same wherever it lands and needs no more
+     * than one cached block. Positions past the end make Read() return 0, like SetPosition().
+     * @param sampleIndex Index of the frame, counted in the looped output when looping is enabled
+     * and at half the sampling rate with HcaDecodeQuality::PreviewHalfRate.
+     */
+    ACB_EXPORT void SeekToSample(std::uint64_t sampleIndex);
+
     ACB_EXPORT auto GetLength() -> std::uint64_t override;
 
+    /**
+     * Decodes a range of blocks on several threads and writes their wave data to a buffer.
+     * @remarks The range is split into one segment per thread. Each segment first decodes the
+     * block before it, usually just one, to rebuild the state carried between blocks. The output is
+     * therefore identical to decoding the blocks one by one from the beginning. The wave header,
+     * looping, the block cache and the stream position are not involved.
+     * @param blockIndex Index of the first block.
+     * @param blockCount Number of blocks to decode.
+     * @param buffer Destination buffer. Block i is written at offset i * GetWaveBlockSize().
+     * @param bufferSize Size of the destination buffer, at least blockCount * GetWaveBlockSize().
+     * @param threadCount Maximum number of threads, or 0 to use one per hardware thread.
+     */
+    ACB_EXPORT void DecodeBlocks(
+        std::uint32_t blockIndex, std::uint32_t blockCount, void *buffer, std::size_t bufferSize,
+        std::uint32_t threadCount
+    );
+
+    /**
+     * Decodes consecutive blocks into planar float buffers, one per channel.
+     * @remarks Samples are scaled by the RVA volume but not clamped. The wave header, looping, the
+     * block cache and the stream position are not involved. When blockIndex does not follow the
+     * last block decoded by this decoder, the blocks before it are decoded first to rebuild the
+     * state carried between blocks, so the output always matches a sequential decode.
+     * @param blockIndex Index of the first block.
+     * @param blockCount Number of blocks to decode.
+     * @param channelWaves Destination of each channel, blockCount * 0x400 samples each, or
+     * blockCount * 0x200 with HcaDecodeQuality::PreviewHalfRate.
+     */
+    ACB_EXPORT void DecodeBlocksPlanar(
+        std::uint32_t blockIndex, std::uint32_t blockCount, float *const *channelWaves
+    );
+
+    /**
+     * Tells which of several candidate keys decrypt an HCA file validly, without decoding it.
+     * @remarks The first few blocks that are not blank are decrypted with each key and checked:
+     * sync word, scale factors in range, and coded data followed by zeros only. Candidates are
+     * tested in parallel. Wrong keys, broken files and streams that are not HCA files do not
+     * throw; they yield FALSE. Blank blocks read the same under every key, so a file without
+     * any other block yields TRUE for every candidate.
+     * @param stream Source stream, positioned at the start of the HCA file. Its position is
+     * changed.
+     * @param candidates Keys to test, as they would be passed to the decoder config.
+     * @param threadCount Maximum number of threads, or 0 to use one per hardware thread.
+     * @return Whether each candidate is valid, in the order of candidates.
+     */
+    [[nodiscard]] ACB_EXPORT static auto ValidateKeys(
+        IStream *stream, const std::vector<HCA_CIPHER_CONFIG> &candidates,
+        std::uint32_t threadCount
+    ) -> std::vector<bool_t>;
+
+    /**
+     * Verifies the checksum of every block of the file, regardless of the checksum policy in the
+     * decoder config. Lets a file be verified once, e.g. at ingest, and then decoded with
+     * HcaChecksumPolicy::Never.
+     * @remarks Blocks are read in large chunks and not decoded. The wave output, the block cache
+     * and the stream position are not involved.
+     * @return TRUE if all blocks are intact, FALSE if any is corrupted or the file is truncated.
+     */
+    [[nodiscard]] ACB_EXPORT auto VerifyBlocks() -> bool_t;
+
+    /**
+     * Computes the minimum size required for decoded wave data block.
+     * @return Computed size.
+     */
+    ACB_EXPORT auto GetWaveBlockSize() -> std::uint32_t;
+
 private:
     void InitializeExtra();
 
@@ -58,6 +164,12 @@ private:
      */
     auto GenerateWaveHeader() -> const std::uint8_t *;
 
+    /**
+     * Writes the wave header for the decoded file.
+     * @param headerBuffer Destination buffer, at least GetWaveHeaderSize() bytes.
+     */
+    void WriteWaveHeader(std::uint8_t *headerBuffer);
+
     /**
      * Computes the minimum size required for generated wave header.
      * @return Computed size.
@@ -77,10 +189,54 @@ private:
     auto DecodeBlock(std::uint32_t blockIndex) -> const std::uint8_t *;
 
     /**
-     * Computes the minimum size required for decoded wave data block.
-     * @return Computed size.
+     * Decodes a block and writes the wave data to the given buffer, bypassing any cache.
+     * @param blockIndex Index of the block.
+     * @param waveBlockBuffer Destination buffer, at least GetWaveBlockSize() bytes.
      */
-    auto GetWaveBlockSize() -> std::uint32_t;
+    void DecodeBlockInto(std::uint32_t blockIndex, std::uint8_t *waveBlockBuffer);
+
+    /**
+     * Reads a raw block from the base stream into the block buffer of a block decoder, and verifies
+     * its checksum if the checksum policy asks for it.
+     * @remarks Safe to call from several threads at once.
+     * @param blockIndex Index of the block.
+     * @param blockDecoder The block decoder.
+     */
+    void ReadBlock(std::uint32_t blockIndex, CHcaBlockDecoder *blockDecoder);
+
+    /**
+     * Tells whether the checksum policy in the decoder config asks to verify a block.
+     * @param blockIndex Index of the block.
+     */
+    auto IsChecksumVerified(std::uint32_t blockIndex) const -> bool_t;
+
+    /**
+     * Brings a block decoder to the state a sequential decode has right before a block, by decoding
+     * the blocks before it and discarding their wave data.
+     * @remarks Usually only the previous block is decoded. More are decoded when blocks reuse
+     * state from the blocks before them.
+     * @param blockIndex Index of the block to be decoded next.
+     * @param blockDecoder The block decoder.
+     */
+    void PreRoll(std::uint32_t blockIndex, CHcaBlockDecoder *blockDecoder);
+
+    /**
+     * Decodes consecutive blocks with a dedicated block decoder. Used by DecodeBlocks().
+     * @param blockIndex Index of the first block.
+     * @param blockCount Number of blocks to decode.
+     * @param buffer Destination buffer of the first block.
+     * @param cancelled Set when another segment fails, to stop before the next block.
+     */
+    void DecodeSegment(
+        std::uint32_t blockIndex, std::uint32_t blockCount, std::uint8_t *buffer,
+        const std::atomic<bool> &cancelled
+    );
+
+    /**
+     * Gets the size of one output sample.
+     * @return The size in bytes.
+     */
+    auto GetSampleSize() const -> std::uint32_t;
 
     /**
      * Map a linear position to a looped position, considering looping range.
@@ -89,18 +245,50 @@ private:
      */
     auto MapLoopedPosition(std::uint64_t linearPosition) -> std::uint64_t;
 
-    std::map<std::uint32_t, const std::uint8_t *> _decodedBlocks;
+    /**
+     * Computes how many decoded blocks the block cache may hold, according to the cache limits in
+     * decoder config.
+     * @return Computed capacity, at least 1.
+     */
+    auto GetBlockCacheCapacity() -> std::uint32_t;
+
+    static constexpr std::uint32_t InvalidBlockIndex = 0xffffffff;
+
+    // Each segment of DecodeBlocks() decodes at least this many blocks, to keep the cost of the
+    // pre-roll block small.
+    static constexpr std::uint32_t MinSegmentBlockCount = 0x10;
+
+    // VerifyBlocks() reads at most this many blocks at a time.
+    static constexpr std::uint32_t VerifyChunkBlockCount = 0x100;
 
-    static constexpr std::uint32_t ChannelCount = 0x10;
+    // ValidateKeys() checks at most this many non-blank blocks.
+    static constexpr std::uint32_t KeyValidationBlockCount = 4;
 
     CHcaAth *_ath;
     CHcaCipher *_cipher;
+    CHcaBlockCache *_blockCache;
+    CHcaBlockDecoder *_blockDecoder;
+    // Prefetch mode only: the background decoder and the block decoder used by its worker.
+    CHcaPrefetcher *_prefetcher;
+    CHcaBlockDecoder *_prefetchBlockDecoder;
     HCA_DECODER_CONFIG _decoderConfig;
-    std::array<CHcaChannel *, ChannelCount> _channels;
+    // Output format resolved from the decoder config. HcaWaveFormat::Default stands for a custom
+    // decodeFunc.
+    HcaWaveFormat _waveFormat;
     std::uint32_t _waveHeaderSize;
     std::uint8_t *_waveHeaderBuffer;
+    // Size of _waveHeaderBuffer, which may be larger than the header after Reset().
+    std::uint32_t _waveHeaderCapacity;
     std::uint32_t _waveBlockSize;
-    std::uint8_t *_hcaBlockBuffer;
+    // Streaming mode only: the block buffer that is reused for every decoded block.
+    std::uint8_t *_streamBlockBuffer;
+    // Size of _streamBlockBuffer, which may be larger than a wave block after Reset().
+    std::uint32_t _streamBlockCapacity;
+    std::uint32_t _streamBlockIndex;
+    // The block after the one last decoded by _blockDecoder, or InvalidBlockIndex.
+    std::uint32_t _nextBlockIndex;
+    // Serializes block reads from the base stream.
+    std::mutex _streamMutex;
     // Position measured by wave output.
     std::uint64_t _position;
 };
@@ -1,7 +1,6 @@
 #ifndef ACB_KAWASHIMA_HCA_CHCAFORMATREADER_H_
 #define ACB_KAWASHIMA_HCA_CHCAFORMATREADER_H_
 
-#include <array>
 #include <cstdint>
 
 #include "acb_cdata.h"
@@ -53,6 +52,12 @@ protected:
     static auto
     ComputeChecksum(void *pData, std::uint32_t dwDataSize, std::uint16_t wInitSum) -> std::uint16_t;
 
+    /**
+     * Switches to another base stream and reads its header, as the constructor does.
+     * @param baseStream The new base stream.
+     */
+    void Reinitialize(IStream *baseStream);
+
     HCA_INFO _hcaInfo;
 
     IStream *_baseStream;
@@ -61,8 +66,6 @@ private:
     void Initialize();
 
     void PrintHcaInfo();
-
-    static const std::array<std::uint16_t, 256> ChecksumTable;
 };
 
 ACB_NS_END
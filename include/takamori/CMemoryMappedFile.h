@@ -0,0 +1,73 @@
+#ifndef ACB_TAKAMORI_CMEMORYMAPPEDFILE_H_
+#define ACB_TAKAMORI_CMEMORYMAPPEDFILE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+ACB_NS_BEGIN
+
+/**
+ * A read-write view of a range of an existing file. Changes made through the view are written to
+ * the file.
+ * @remarks The file is never resized. The range does not have to be aligned to pages.
+ */
+class ACB_EXPORT CMemoryMappedFile final {
+
+public:
+    /**
+     * Maps a whole file.
+     * @param fileName Path of the file.
+     */
+    explicit CMemoryMappedFile(const std::string &fileName);
+
+    /**
+     * Maps a range of a file.
+     * @param fileName Path of the file.
+     * @param offset Offset of the range.
+     * @param size Size of the range. It must not reach past the end of the file.
+     */
+    CMemoryMappedFile(const std::string &fileName, std::uint64_t offset, std::uint64_t size);
+
+    CMemoryMappedFile(const CMemoryMappedFile &) = delete;
+
+    CMemoryMappedFile(CMemoryMappedFile &&) = delete;
+
+    auto operator=(const CMemoryMappedFile &) -> CMemoryMappedFile & = delete;
+
+    auto operator=(CMemoryMappedFile &&) -> CMemoryMappedFile & = delete;
+
+    ~CMemoryMappedFile();
+
+    /**
+     * Gets the mapped range.
+     */
+    auto GetData() -> std::uint8_t *;
+
+    [[nodiscard]] auto GetSize() const -> std::uint64_t;
+
+    /**
+     * Writes the changes made so far to the file and waits for them to complete.
+     */
+    void Flush();
+
+private:
+    void Map(const std::string &fileName, std::uint64_t offset, std::uint64_t size, bool_t whole);
+
+    void Unmap();
+
+    // The view starts at a page boundary, at or before the mapped range.
+    std::uint8_t *_view;
+    std::uint64_t _viewSize;
+    std::uint8_t *_data;
+    std::uint64_t _size;
+    // File descriptor or HANDLE of the file, and HANDLE of the mapping on Windows.
+    std::intptr_t _file;
+    void *_mapping;
+};
+
+ACB_NS_END
+
+#endif // ACB_TAKAMORI_CMEMORYMAPPEDFILE_H_
@@ -8,17 +8,23 @@
 #include <cstdint>
 #include <cstring>
 #include <format>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "acb_enum.h"
+#include "ichinose/CAfs2Archive.h"
+#include "internal/CHcaBlockRecipher.h"
 #include "internal/CHcaCipher.h"
-#include "internal/CHcaData.h"
+#include "internal/CTaskRunner.h"
 #include "kawashima/hca/CHcaCipherConverter.h"
 #include "kawashima/hca/hca_native.h"
 #include "kawashima/hca/hca_utils.h"
+#include "takamori/CMemoryMappedFile.h"
 #include "takamori/exceptions/CArgumentException.h"
 #include "takamori/exceptions/CException.h"
 #include "takamori/exceptions/CFormatException.h"
+#include "takamori/streams/CMemoryStream.h"
 
 #ifdef _MSC_VER
 #undef max
@@ -38,12 +44,21 @@ ACB_NS_BEGIN
 
 CHcaCipherConverter::CHcaCipherConverter(
     IStream *stream, const HCA_CIPHER_CONFIG &cryptFrom, const HCA_CIPHER_CONFIG &cryptTo
+)
+    : CHcaCipherConverter(stream, cryptFrom, cryptTo, FALSE) {}
+
+CHcaCipherConverter::CHcaCipherConverter(
+    IStream *stream, const HCA_CIPHER_CONFIG &cryptFrom, const HCA_CIPHER_CONFIG &cryptTo,
+    bool_t streamingEnabled
 )
     : MyBase(stream) {
-    _headerBuffer = nullptr;
-    _ccFrom       = cryptFrom;
-    _ccTo         = cryptTo;
-    _position     = 0;
+    _headerBuffer      = nullptr;
+    _ccFrom            = cryptFrom;
+    _ccTo              = cryptTo;
+    _streamingEnabled  = streamingEnabled;
+    _streamBlockBuffer = nullptr;
+    _streamBlockIndex  = InvalidBlockIndex;
+    _position          = 0;
     InitializeExtra();
 }
 
@@ -56,10 +71,18 @@ CHcaCipherConverter::~CHcaCipherConverter() {
         delete _cipherTo;
         _cipherTo = nullptr;
     }
+    if (_recipher) {
+        delete _recipher;
+        _recipher = nullptr;
+    }
     if (_headerBuffer) {
         delete[] _headerBuffer;
         _headerBuffer = nullptr;
     }
+    if (_streamBlockBuffer) {
+        delete[] _streamBlockBuffer;
+        _streamBlockBuffer = nullptr;
+    }
     for (const auto &ptr : _blockBuffers) {
         delete[] ptr.second;
     }
@@ -73,6 +96,11 @@ void CHcaCipherConverter::InitializeExtra() {
     ccFrom.cipherType   = hcaInfo.cipherType;
     _cipherFrom         = new CHcaCipher(ccFrom);
     _cipherTo           = new CHcaCipher(ccTo);
+    _recipher           = new CHcaBlockRecipher(*_cipherFrom, *_cipherTo);
+
+    if (_streamingEnabled) {
+        _streamBlockBuffer = new std::uint8_t[hcaInfo.blockSize];
+    }
 }
 
 auto CHcaCipherConverter::ConvertHeader() -> const std::uint8_t * {
@@ -89,6 +117,13 @@ auto CHcaCipherConverter::ConvertHeader() -> const std::uint8_t * {
     stream->Seek(0, StreamSeekOrigin::Begin);
     ENSURE_READ_ALL_BUFFER(headerBuffer, hcaInfo.dataOffset);
 
+    RewriteHeader(headerBuffer, hcaInfo.dataOffset, _ccTo.cipherType);
+    return headerBuffer;
+}
+
+void CHcaCipherConverter::RewriteHeader(
+    std::uint8_t *headerBuffer, std::uint32_t dataOffset, HcaCipherType cipherType
+) {
     std::uint32_t cursor = 0;
 
     // HCA
@@ -129,18 +164,26 @@ auto CHcaCipherConverter::ConvertHeader() -> const std::uint8_t * {
     // CIPH
     auto *ciph = reinterpret_cast<HCA_CIPHER_HEADER *>(headerBuffer + cursor);
     if (areMagicMatch(ciph->ciph, Magic::CIPHER)) {
-        auto newCipherType = static_cast<std::uint16_t>(_ccTo.cipherType);
+        auto newCipherType = static_cast<std::uint16_t>(cipherType);
         newCipherType      = std::byteswap(newCipherType);
         ciph->type         = newCipherType;
     }
 
     // Recompute checksum and write to the header.
-    const auto newHeaderChecksum = ComputeChecksum(headerBuffer, hcaInfo.dataOffset - 2, 0);
-    *(std::uint16_t *)(headerBuffer + hcaInfo.dataOffset - 2) = std::byteswap(newHeaderChecksum);
-    return headerBuffer;
+    const auto newHeaderChecksum = ComputeChecksum(headerBuffer, dataOffset - 2, 0);
+    *(std::uint16_t *)(headerBuffer + dataOffset - 2) = std::byteswap(newHeaderChecksum);
 }
 
 auto CHcaCipherConverter::ConvertBlock(std::uint32_t blockIndex) -> const std::uint8_t * {
+    if (_streamingEnabled) {
+        if (_streamBlockIndex != blockIndex) {
+            _streamBlockIndex = InvalidBlockIndex;
+            ConvertBlockInto(blockIndex, _streamBlockBuffer);
+            _streamBlockIndex = blockIndex;
+        }
+        return _streamBlockBuffer;
+    }
+
     auto &blockBuffers = _blockBuffers;
     {
         const auto item = blockBuffers.find(blockIndex);
@@ -149,47 +192,35 @@ auto CHcaCipherConverter::ConvertBlock(std::uint32_t blockIndex) -> const std::u
         }
     }
 
+    auto blockBuffer         = new std::uint8_t[_hcaInfo.blockSize];
+    blockBuffers[blockIndex] = blockBuffer;
+    ConvertBlockInto(blockIndex, blockBuffer);
+    return blockBuffer;
+}
+
+void CHcaCipherConverter::ConvertBlockInto(std::uint32_t blockIndex, std::uint8_t *blockBuffer) {
     const auto &hcaInfo = _hcaInfo;
     const auto stream   = _baseStream;
     std::size_t bufferSize;
     std::size_t actualRead;
 
-    stream->Seek(hcaInfo.dataOffset + blockIndex * hcaInfo.blockSize, StreamSeekOrigin::Begin);
-    auto blockBuffer         = new std::uint8_t[hcaInfo.blockSize];
-    blockBuffers[blockIndex] = blockBuffer;
+    stream->Seek(
+        hcaInfo.dataOffset + static_cast<std::uint64_t>(blockIndex) * hcaInfo.blockSize,
+        StreamSeekOrigin::Begin
+    );
     ENSURE_READ_ALL_BUFFER(blockBuffer, hcaInfo.blockSize);
 
-    if (ComputeChecksum(blockBuffer, hcaInfo.blockSize, 0) != 0) {
+    // Verify, decipher, recipher and fix the block checksum.
+    if (!_recipher->Convert(blockBuffer, hcaInfo.blockSize)) {
         throw CFormatException(
             std::format("CHcaCipherConverter::ConvertBlock @ Block#{}", blockIndex)
         );
     }
-
-    // Decipher.
-    const auto validDataSize = static_cast<std::uint32_t>(hcaInfo.blockSize - 2);
-    _cipherFrom->Decrypt(blockBuffer, validDataSize);
-
-    // Check magic piece of plain text.
-    CHcaData data(blockBuffer, hcaInfo.blockSize, hcaInfo.blockSize);
-    const auto magic = data.GetBit(16);
-    if (magic != 0xffff) {
-        throw CFormatException(
-            std::format("CHcaCipherConverter::ConvertBlock @ Block#{}", blockIndex)
-        );
-    }
-
-    // Recipher.
-    _cipherTo->Encrypt(blockBuffer, validDataSize);
-
-    // Fix block checksum.
-    const auto checksum = ComputeChecksum(blockBuffer, validDataSize, 0);
-    *(std::uint16_t *)(blockBuffer + validDataSize) = std::byteswap(checksum);
-    return blockBuffer;
 }
 
 auto CHcaCipherConverter::GetLength() -> std::uint64_t {
     const auto &hcaInfo = _hcaInfo;
-    return hcaInfo.dataOffset + hcaInfo.blockCount * hcaInfo.blockSize;
+    return hcaInfo.dataOffset + static_cast<std::uint64_t>(hcaInfo.blockCount) * hcaInfo.blockSize;
 }
 
 void CHcaCipherConverter::SetPosition(std::uint64_t value) {
@@ -238,7 +269,6 @@ auto CHcaCipherConverter::Read(
         const auto blockIndex =
             static_cast<std::uint32_t>((streamPosition - hcaInfo.dataOffset) / hcaInfo.blockSize);
         const auto startOffset = (streamPosition - hcaInfo.dataOffset) % hcaInfo.blockSize;
-        const auto blockData   = ConvertBlock(blockIndex);
         const auto copyLength  = std::min(
             streamLength - streamPosition,
             std::min(
@@ -246,9 +276,16 @@ auto CHcaCipherConverter::Read(
                 static_cast<std::uint64_t>(hcaInfo.blockSize) - startOffset
             )
         );
-        std::memcpy(
-            byteBuffer + offset, blockData + startOffset, static_cast<std::size_t>(copyLength)
-        );
+        if (_streamingEnabled && copyLength == hcaInfo.blockSize &&
+            blockIndex != _streamBlockIndex) {
+            // The whole block fits, so skip the intermediate buffer.
+            ConvertBlockInto(blockIndex, byteBuffer + offset);
+        } else {
+            const auto blockData = ConvertBlock(blockIndex);
+            std::memcpy(
+                byteBuffer + offset, blockData + startOffset, static_cast<std::size_t>(copyLength)
+            );
+        }
         streamPosition += copyLength;
         count -= copyLength;
         offset += copyLength;
@@ -259,4 +296,168 @@ auto CHcaCipherConverter::Read(
     return totalRead;
 }
 
+// In-place conversion of several files is split into tasks of at most this many blocks.
+static constexpr std::uint32_t InPlaceTaskBlockCount = 0x100;
+
+/**
+ * An HCA file being converted in place.
+ */
+struct InPlaceTarget {
+    std::uint8_t *data;
+    HCA_INFO hcaInfo;
+    CHcaBlockRecipher recipher;
+};
+
+/**
+ * A range of blocks of an InPlaceTarget.
+ */
+struct InPlaceTask {
+    std::size_t targetIndex;
+    std::uint32_t blockIndex;
+    std::uint32_t blockCount;
+};
+
+static auto OpenInPlaceTarget(
+    std::uint8_t *data, std::uint64_t size, const HCA_CIPHER_CONFIG &cryptFrom,
+    const HCA_CIPHER_CONFIG &cryptTo
+) -> InPlaceTarget {
+    // Reads the header, and sets up the ciphers the same way as a converting stream.
+    CMemoryStream stream(data, size, FALSE);
+    CHcaCipherConverter converter(&stream, cryptFrom, cryptTo);
+    const auto &hcaInfo = converter.GetHcaInfo();
+    if (hcaInfo.blockSize == 0) {
+        throw CException(OpResult::FormatError, "Invalid block size.");
+    }
+    // Every block is accessed through the mapping directly, so all of them must lie inside it.
+    if (converter.GetLength() > size) {
+        throw CException(OpResult::FormatError, "Unexpected end of file.");
+    }
+    auto ccFrom         = cryptFrom;
+    ccFrom.cipherType   = hcaInfo.cipherType;
+    return {data, hcaInfo, CHcaBlockRecipher(CHcaCipher(ccFrom), CHcaCipher(cryptTo))};
+}
+
+static auto GetBlock(const InPlaceTarget &target, std::uint32_t blockIndex) -> std::uint8_t * {
+    const auto &hcaInfo = target.hcaInfo;
+    return target.data + hcaInfo.dataOffset +
+           static_cast<std::size_t>(blockIndex) * hcaInfo.blockSize;
+}
+
+void CHcaCipherConverter::ConvertInPlace(
+    void *data, std::uint64_t size, const HCA_CIPHER_CONFIG &cryptFrom,
+    const HCA_CIPHER_CONFIG &cryptTo
+) {
+    if (!data) {
+        throw CArgumentException("CHcaCipherConverter::ConvertInPlace");
+    }
+    const auto bytes     = static_cast<std::uint8_t *>(data);
+    const auto target    = OpenInPlaceTarget(bytes, size, cryptFrom, cryptTo);
+    const auto &hcaInfo  = target.hcaInfo;
+    const auto blockSize = hcaInfo.blockSize;
+
+    for (std::uint32_t i = 0; i < hcaInfo.blockCount; ++i) {
+        if (!target.recipher.Verify(GetBlock(target, i), blockSize)) {
+            throw CFormatException(
+                std::format("CHcaCipherConverter::ConvertInPlace @ Block#{}", i)
+            );
+        }
+    }
+    for (std::uint32_t i = 0; i < hcaInfo.blockCount; ++i) {
+        target.recipher.Convert(GetBlock(target, i), blockSize);
+    }
+    RewriteHeader(target.data, hcaInfo.dataOffset, cryptTo.cipherType);
+}
+
+void CHcaCipherConverter::ConvertFileInPlace(
+    const std::string &fileName, const HCA_CIPHER_CONFIG &cryptFrom,
+    const HCA_CIPHER_CONFIG &cryptTo
+) {
+    CMemoryMappedFile file(fileName);
+    ConvertInPlace(file.GetData(), file.GetSize(), cryptFrom, cryptTo);
+    file.Flush();
+}
+
+void CHcaCipherConverter::ConvertFileInPlace(
+    const std::string &fileName, const AFS2_FILE_RECORD &record,
+    const HCA_CIPHER_CONFIG &cryptFrom, const HCA_CIPHER_CONFIG &cryptTo
+) {
+    CMemoryMappedFile file(fileName, record.fileOffsetAligned, record.fileSize);
+    ConvertInPlace(file.GetData(), file.GetSize(), cryptFrom, cryptTo);
+    file.Flush();
+}
+
+void CHcaCipherConverter::ConvertArchiveInPlace(
+    const CAfs2Archive &archive, const HCA_CIPHER_CONFIG &cryptFrom,
+    const HCA_CIPHER_CONFIG &cryptTo, std::uint32_t threadCount
+) {
+    CMemoryMappedFile file(archive.GetFileName());
+    const auto fileData = file.GetData();
+    const auto fileSize = file.GetSize();
+
+    std::vector<InPlaceTarget> targets;
+    std::vector<std::uint32_t> cueIds;
+    std::vector<InPlaceTask> tasks;
+    for (const auto &[cueId, record] : archive.GetFiles()) {
+        const auto corrupted = [cueId] {
+            return CFormatException(
+                std::format("CHcaCipherConverter::ConvertArchiveInPlace @ Cue#{}", cueId)
+            );
+        };
+        if (record.fileOffsetAligned > fileSize ||
+            record.fileSize > fileSize - record.fileOffsetAligned) {
+            throw corrupted();
+        }
+        const auto data = fileData + record.fileOffsetAligned;
+        // Only entries without the HCA magic are other files. An HCA file that fails to parse is
+        // corrupted, and must not be reported as converted.
+        std::uint32_t magic = 0;
+        if (record.fileSize >= sizeof(magic)) {
+            std::memcpy(&magic, data, sizeof(magic));
+        }
+        if (!areMagicMatch(magic, Magic::HCA)) {
+            continue;
+        }
+
+        const auto targetIndex = targets.size();
+        try {
+            targets.push_back(OpenInPlaceTarget(data, record.fileSize, cryptFrom, cryptTo));
+        } catch (CException &) {
+            throw corrupted();
+        } catch (std::runtime_error &) {
+            throw corrupted();
+        }
+        cueIds.push_back(cueId);
+        const auto blockCount = targets.back().hcaInfo.blockCount;
+        for (std::uint32_t i = 0; i < blockCount; i += InPlaceTaskBlockCount) {
+            tasks.push_back({targetIndex, i, std::min(blockCount - i, InPlaceTaskBlockCount)});
+        }
+    }
+
+    // Verify everything first, so that the archive is left untouched if any block is corrupted.
+    CTaskRunner::Run(tasks.size(), threadCount, [&](std::size_t taskIndex, const auto &) {
+        const auto &task   = tasks[taskIndex];
+        const auto &target = targets[task.targetIndex];
+        for (auto i = task.blockIndex; i < task.blockIndex + task.blockCount; ++i) {
+            if (!target.recipher.Verify(GetBlock(target, i), target.hcaInfo.blockSize)) {
+                throw CFormatException(std::format(
+                    "CHcaCipherConverter::ConvertArchiveInPlace @ Cue#{} Block#{}",
+                    cueIds[task.targetIndex], i
+                ));
+            }
+        }
+    });
+    CTaskRunner::Run(tasks.size(), threadCount, [&](std::size_t taskIndex, const auto &) {
+        const auto &task   = tasks[taskIndex];
+        const auto &target = targets[task.targetIndex];
+        for (auto i = task.blockIndex; i < task.blockIndex + task.blockCount; ++i) {
+            target.recipher.Convert(GetBlock(target, i), target.hcaInfo.blockSize);
+        }
+    });
+    for (const auto &target : targets) {
+        RewriteHeader(target.data, target.hcaInfo.dataOffset, cryptTo.cipherType);
+    }
+
+    file.Flush();
+}
+
 ACB_NS_END
@@ -1,53 +1,83 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "acb_cdata.h"
 #include "acb_enum.h"
 #include "acb_env_ns.h"
 #include "kawashima/hca/CHcaDecoder.h"
+#include "kawashima/hca/CHcaDecoderConfig.h"
 #include "kawashima/hca/hca_utils.h"
 #include "kawashima/wave/wave_native.h"
 #include "takamori/exceptions/CArgumentException.h"
 #include "takamori/streams/CMemoryStream.h"
 
 #include "./internal/CHcaAth.h"
-#include "./internal/CHcaChannel.h"
+#include "./internal/CHcaBlockCache.h"
+#include "./internal/CHcaBlockDecoder.h"
 #include "./internal/CHcaCipher.h"
-#include "./internal/CHcaData.h"
+#include "./internal/CHcaPrefetcher.h"
+#include "./internal/CHcaWaveWriter.h"
+#include "./internal/CTaskRunner.h"
 
 ACB_NS_BEGIN
 
 CHcaDecoder::CHcaDecoder(IStream *stream): MyClass(stream, HCA_DECODER_CONFIG()) {}
 
 CHcaDecoder::CHcaDecoder(IStream *stream, const HCA_DECODER_CONFIG &decoderConfig): MyBase(stream) {
-    _cipher = nullptr;
-    _ath    = nullptr;
-    for (auto &_channel : _channels) {
-        _channel = nullptr;
-    }
-    _waveHeaderBuffer = _hcaBlockBuffer = nullptr;
+    _cipher               = nullptr;
+    _ath                  = nullptr;
+    _blockCache           = nullptr;
+    _blockDecoder         = nullptr;
+    _prefetcher           = nullptr;
+    _prefetchBlockDecoder = nullptr;
+    _waveHeaderBuffer = _streamBlockBuffer = nullptr;
     _waveHeaderSize = _waveBlockSize = 0;
-    _position                        = 0;
-    _decoderConfig                   = decoderConfig;
+    _waveHeaderCapacity = _streamBlockCapacity = 0;
+    _streamBlockIndex                          = InvalidBlockIndex;
+    _nextBlockIndex                            = InvalidBlockIndex;
+    _position                                  = 0;
+    _decoderConfig                             = decoderConfig;
+    _waveFormat                                = HcaWaveFormat::Default;
     InitializeExtra();
 }
 
 CHcaDecoder::~CHcaDecoder() {
-    for (const auto &v : _decodedBlocks) {
-        delete[] v.second;
+    // Stop the worker first, since it uses everything else.
+    if (_prefetcher) {
+        delete _prefetcher;
+        _prefetcher = nullptr;
+    }
+
+    if (_prefetchBlockDecoder) {
+        delete _prefetchBlockDecoder;
+        _prefetchBlockDecoder = nullptr;
+    }
+
+    if (_blockCache) {
+        delete _blockCache;
+        _blockCache = nullptr;
     }
-    _decodedBlocks.clear();
 
     if (_waveHeaderBuffer) {
         delete[] _waveHeaderBuffer;
         _waveHeaderBuffer = nullptr;
     }
 
-    if (_hcaBlockBuffer) {
-        delete[] _hcaBlockBuffer;
-        _hcaBlockBuffer = nullptr;
+    if (_blockDecoder) {
+        delete _blockDecoder;
+        _blockDecoder = nullptr;
+    }
+
+    if (_streamBlockBuffer) {
+        delete[] _streamBlockBuffer;
+        _streamBlockBuffer = nullptr;
     }
 
     if (_ath) {
@@ -59,79 +89,168 @@ CHcaDecoder::~CHcaDecoder() {
         delete _cipher;
         _cipher = nullptr;
     }
+}
 
-    for (auto &_channel : _channels) {
-        if (_channel) {
-            delete _channel;
-            _channel = nullptr;
-        }
+void CHcaDecoder::Reset(IStream *stream, const HCA_DECODER_CONFIG &decoderConfig) {
+    // Stop the worker first, since it uses everything else.
+    if (_prefetcher) {
+        delete _prefetcher;
+        _prefetcher = nullptr;
     }
+
+    Reinitialize(stream);
+    _decoderConfig = decoderConfig;
+    InitializeExtra();
 }
 
 void CHcaDecoder::InitializeExtra() {
     auto &hcaInfo = _hcaInfo;
 
+    // Everything derived from the previous file, if reset.
+    _waveHeaderSize = _waveBlockSize = 0;
+    _streamBlockIndex                = InvalidBlockIndex;
+    _nextBlockIndex                  = InvalidBlockIndex;
+    _position                        = 0;
+
     // Initialize adjustment and cipher tables.
-    _ath = new CHcaAth();
+    if (!_ath) {
+        _ath = new CHcaAth();
+    }
     if (!_ath->Init(hcaInfo.athType, hcaInfo.samplingRate)) {
         throw CException();
     }
     auto &cipherConfig      = _decoderConfig.cipherConfig;
     cipherConfig.cipherType = hcaInfo.cipherType;
-    _cipher                 = new CHcaCipher(cipherConfig);
+    if (_cipher) {
+        *_cipher = CHcaCipher(cipherConfig);
+    } else {
+        _cipher = new CHcaCipher(cipherConfig);
+    }
+
+    // Resolve the output format. Known decode functions are replaced by block converters.
+    _waveFormat = _decoderConfig.waveFormat;
+    if (_waveFormat == HcaWaveFormat::Default) {
+        _waveFormat = CHcaWaveWriter::GetFormat(_decoderConfig.decodeFunc);
+    } else if (CHcaWaveWriter::GetSampleSize(_waveFormat) == 0) {
+        throw CArgumentException("CHcaDecoder::InitializeExtra");
+    }
+
+    switch (_decoderConfig.checksumPolicy) {
+    case HcaChecksumPolicy::Always:
+    case HcaChecksumPolicy::FirstBlocks:
+    case HcaChecksumPolicy::Sampled:
+    case HcaChecksumPolicy::Never:
+        break;
+    default:
+        throw CArgumentException("CHcaDecoder::InitializeExtra");
+    }
+
+    switch (_decoderConfig.decodeQuality) {
+    case HcaDecodeQuality::Full:
+    case HcaDecodeQuality::Preview:
+    case HcaDecodeQuality::PreviewHalfRate:
+        break;
+    default:
+        throw CArgumentException("CHcaDecoder::InitializeExtra");
+    }
 
     // Prepare the channel decoders.
-    _channels.fill(nullptr);
-    std::array<std::uint8_t, 0x10> r = {};
-    std::uint32_t b                  = hcaInfo.channelCount / hcaInfo.compR03;
-    if (hcaInfo.compR07 && b > 1) {
-        auto c = r.begin();
-        for (auto i = 0; i < hcaInfo.compR03; ++i, c += b) {
-            switch (b) {
-            case 2:
-            case 3:
-                c[0] = 1;
-                c[1] = 2;
-                break;
-            case 4:
-                c[0] = 1;
-                c[1] = 2;
-                if (hcaInfo.compR04 == 0) {
-                    c[2] = 1;
-                    c[3] = 2;
-                }
-                break;
-            case 5:
-                c[0] = 1;
-                c[1] = 2;
-                if (hcaInfo.compR04 <= 2) {
-                    c[3] = 1;
-                    c[4] = 2;
+    if (_blockDecoder) {
+        _blockDecoder->Reconfigure(
+            hcaInfo,
+            _ath->GetTable(),
+            _cipher,
+            _waveFormat,
+            _decoderConfig.decodeFunc,
+            _decoderConfig.decodeQuality
+        );
+    } else {
+        _blockDecoder = new CHcaBlockDecoder(
+            hcaInfo,
+            _ath->GetTable(),
+            _cipher,
+            _waveFormat,
+            _decoderConfig.decodeFunc,
+            _decoderConfig.decodeQuality
+        );
+    }
+
+    // A wave header generated before a reset is written again in place when it still fits.
+    if (_waveHeaderBuffer) {
+        if (_waveHeaderCapacity >= GetWaveHeaderSize()) {
+            WriteWaveHeader(_waveHeaderBuffer);
+        } else {
+            delete[] _waveHeaderBuffer;
+            _waveHeaderBuffer   = nullptr;
+            _waveHeaderCapacity = 0;
+        }
+    }
+
+    if (_decoderConfig.prefetchBlockCount > 0) {
+        if (_prefetchBlockDecoder) {
+            _prefetchBlockDecoder->Reconfigure(
+                hcaInfo,
+                _ath->GetTable(),
+                _cipher,
+                _waveFormat,
+                _decoderConfig.decodeFunc,
+                _decoderConfig.decodeQuality
+            );
+        } else {
+            _prefetchBlockDecoder = new CHcaBlockDecoder(
+                hcaInfo,
+                _ath->GetTable(),
+                _cipher,
+                _waveFormat,
+                _decoderConfig.decodeFunc,
+                _decoderConfig.decodeQuality
+            );
+        }
+        _prefetcher = new CHcaPrefetcher(
+            hcaInfo.blockCount,
+            GetWaveBlockSize(),
+            _decoderConfig.prefetchBlockCount,
+            [this](std::uint32_t blockIndex, bool_t continued, std::uint8_t *waveBlockBuffer) {
+                const auto blockDecoder = _prefetchBlockDecoder;
+                if (!continued) {
+                    PreRoll(blockIndex, blockDecoder);
                 }
-                break;
-            case 6:
-            case 7:
-                c[0] = 1;
-                c[1] = 2;
-                c[4] = 1;
-                c[5] = 2;
-                // Fall through
-            case 8:
-                c[6] = 1;
-                c[7] = 2;
-                break;
-            default:
-                throw CArgumentException();
+                ReadBlock(blockIndex, blockDecoder);
+                blockDecoder->DecodeBlock();
+                blockDecoder->WriteWave(waveBlockBuffer);
+            }
+        );
+    } else if (_decoderConfig.streamingEnabled) {
+        if (_streamBlockCapacity < GetWaveBlockSize()) {
+            if (_streamBlockBuffer) {
+                delete[] _streamBlockBuffer;
+                _streamBlockBuffer   = nullptr;
+                _streamBlockCapacity = 0;
             }
+            _streamBlockBuffer   = new std::uint8_t[GetWaveBlockSize()];
+            _streamBlockCapacity = GetWaveBlockSize();
         }
+    } else if (_blockCache) {
+        _blockCache->Reset(hcaInfo.blockCount, GetWaveBlockSize(), GetBlockCacheCapacity());
+    } else {
+        _blockCache =
+            new CHcaBlockCache(hcaInfo.blockCount, GetWaveBlockSize(), GetBlockCacheCapacity());
+    }
+}
+
+auto CHcaDecoder::GetBlockCacheCapacity() -> std::uint32_t {
+    // Copied out of the packed config, whose members std::min() cannot bind a reference to.
+    const auto blockCacheCount = _decoderConfig.blockCacheCount;
+    const auto blockCacheSize  = _decoderConfig.blockCacheSize;
+    std::uint32_t capacity     = _hcaInfo.blockCount;
+    if (blockCacheCount > 0) {
+        capacity = std::min(capacity, blockCacheCount);
     }
-    auto channel = _channels.begin();
-    for (std::uint32_t i = 0; i < hcaInfo.channelCount; ++i, ++channel) {
-        *channel           = new CHcaChannel();
-        (*channel)->type   = r[i];
-        (*channel)->value3 = &(*channel)->value[hcaInfo.compR06 + hcaInfo.compR07];
-        (*channel)->count  = hcaInfo.compR06 + ((r[i] != 2) ? hcaInfo.compR07 : 0);
+    if (blockCacheSize > 0) {
+        const auto blocksInBudget = blockCacheSize / GetWaveBlockSize();
+        capacity = static_cast<std::uint32_t>(std::min<std::uint64_t>(capacity, blocksInBudget));
     }
+    return std::max(capacity, 1u);
 }
 
 auto CHcaDecoder::GetWaveHeaderSize() -> std::uint32_t {
@@ -158,12 +277,18 @@ auto CHcaDecoder::GetWaveHeaderSize() -> std::uint32_t {
 }
 
 auto CHcaDecoder::GenerateWaveHeader() -> const std::uint8_t * {
-    if (_waveHeaderBuffer) {
-        return _waveHeaderBuffer;
+    if (!_waveHeaderBuffer) {
+        const auto headerSize = GetWaveHeaderSize();
+        _waveHeaderBuffer     = new std::uint8_t[headerSize];
+        _waveHeaderCapacity   = headerSize;
+        WriteWaveHeader(_waveHeaderBuffer);
     }
+    return _waveHeaderBuffer;
+}
+
+void CHcaDecoder::WriteWaveHeader(std::uint8_t *headerBuffer) {
     const auto &hcaInfo   = _hcaInfo;
     const auto headerSize = GetWaveHeaderSize();
-    auto headerBuffer     = (_waveHeaderBuffer = new std::uint8_t[headerSize]);
     std::memset(headerBuffer, 0, headerSize);
 
     WaveRiffSection wavRiff = {
@@ -185,24 +310,29 @@ auto CHcaDecoder::GenerateWaveHeader() -> const std::uint8_t * {
         0
     };
 
-    wavRiff.fmtType         = static_cast<std::uint16_t>((WaveSettings::BitPerChannel > 0) ? 1 : 3);
+    const auto isFloat =
+        _waveFormat == HcaWaveFormat::Float ||
+        (_waveFormat == HcaWaveFormat::Default && WaveSettings::BitPerChannel == 0);
+    wavRiff.fmtType         = static_cast<std::uint16_t>(isFloat ? 3 : 1);
     wavRiff.fmtChannelCount = static_cast<std::uint16_t>(hcaInfo.channelCount);
-    wavRiff.fmtBitCount     = static_cast<std::uint16_t>(
-        (WaveSettings::BitPerChannel > 0) ? WaveSettings::BitPerChannel : 32
-    );
-    wavRiff.fmtSamplingRate = hcaInfo.samplingRate;
+    wavRiff.fmtBitCount     = static_cast<std::uint16_t>(GetSampleSize() * 8);
+    // Half-rate decoding writes half as many frames per block, at half the sampling rate.
+    const auto frameCount   = _blockDecoder->GetFrameCount();
+    const auto rateShift    = frameCount < CHcaBlockDecoder::BlockFrameCount ? 1u : 0u;
+    wavRiff.fmtSamplingRate = hcaInfo.samplingRate >> rateShift;
     wavRiff.fmtSamplingSize =
         static_cast<std::uint16_t>(wavRiff.fmtBitCount / 8 * wavRiff.fmtChannelCount);
     wavRiff.fmtSamplesPerSec = wavRiff.fmtSamplingRate * wavRiff.fmtSamplingSize;
     if (hcaInfo.loopExists) {
         wavSmpl.samplePeriod =
             static_cast<std::uint32_t>(1 / (double)wavRiff.fmtSamplingRate * 1000000000);
-        wavSmpl.loopStart = hcaInfo.loopStart * 0x80 * 8 + hcaInfo.fmtR02; // fmtR02 is muteFooter
-        wavSmpl.loopEnd   = hcaInfo.loopEnd * 0x80 * 8;
+        // fmtR02 is muteFooter
+        wavSmpl.loopStart     = hcaInfo.loopStart * frameCount + (hcaInfo.fmtR02 >> rateShift);
+        wavSmpl.loopEnd       = hcaInfo.loopEnd * frameCount;
         wavSmpl.loopPlayCount = (hcaInfo.loopR01 == 0x80) ? 0 : hcaInfo.loopR01;
     } else if (WaveSettings::SoftLoop) {
         wavSmpl.loopStart = 0;
-        wavSmpl.loopEnd   = hcaInfo.blockCount * 0x80 * 8;
+        wavSmpl.loopEnd   = hcaInfo.blockCount * frameCount;
     }
     if (hcaInfo.commentLength > 0) {
         wavNote.noteSize = 4 + hcaInfo.commentLength + 1;
@@ -211,7 +341,7 @@ auto CHcaDecoder::GenerateWaveHeader() -> const std::uint8_t * {
         }
     }
     wavData.dataSize = wavRiff.fmtSamplingSize *
-                       (hcaInfo.blockCount * 0x80 * 8 +
+                       (hcaInfo.blockCount * frameCount +
                         (wavSmpl.loopEnd - wavSmpl.loopStart) * _decoderConfig.loopCount);
     wavRiff.riffSize = static_cast<std::uint32_t>(
         0x1C + ((hcaInfo.loopExists && !WaveSettings::SoftLoop) ? sizeof(wavSmpl) : 0) +
@@ -235,111 +365,342 @@ auto CHcaDecoder::GenerateWaveHeader() -> const std::uint8_t * {
     WRITE_STRUCT(wavData);
 
 #undef WRITE_STRUCT
-
-    return headerBuffer;
 }
 
 auto CHcaDecoder::GetWaveBlockSize() -> std::uint32_t {
     if (_waveBlockSize) {
         return _waveBlockSize;
     }
-    std::uint32_t audioBitPerChannel =
-        WaveSettings::BitPerChannel != 0 ? WaveSettings::BitPerChannel : sizeof(float);
     std::uint32_t waveBlockSize =
-        0x80 * (audioBitPerChannel / sizeof(std::uint8_t)) * _hcaInfo.channelCount;
+        _blockDecoder->GetFrameCount() * GetSampleSize() * _hcaInfo.channelCount;
     _waveBlockSize = waveBlockSize;
     return waveBlockSize;
 }
 
+auto CHcaDecoder::GetSampleSize() const -> std::uint32_t {
+    if (_waveFormat != HcaWaveFormat::Default) {
+        return CHcaWaveWriter::GetSampleSize(_waveFormat);
+    }
+    // A custom decode function writes WaveSettings::BitPerChannel bits, or floats when it is 0.
+    return WaveSettings::BitPerChannel != 0 ? WaveSettings::BitPerChannel / 8
+                                            : static_cast<std::uint32_t>(sizeof(float));
+}
+
 auto CHcaDecoder::DecodeBlock(std::uint32_t blockIndex) -> const std::uint8_t * {
-    auto &decodedBlocks = _decodedBlocks;
+    if (_prefetcher) {
+        return _prefetcher->Acquire(blockIndex);
+    }
+
+    if (_decoderConfig.streamingEnabled) {
+        if (_streamBlockIndex != blockIndex) {
+            _streamBlockIndex = InvalidBlockIndex;
+            DecodeBlockInto(blockIndex, _streamBlockBuffer);
+            _streamBlockIndex = blockIndex;
+        }
+        return _streamBlockBuffer;
+    }
+
+    const auto blockCache = _blockCache;
     {
-        const auto decodedItem = decodedBlocks.find(blockIndex);
-        if (decodedItem != decodedBlocks.cend()) {
-            return decodedItem->second;
+        const auto cachedBlock = blockCache->Find(blockIndex);
+        if (cachedBlock) {
+            return cachedBlock;
         }
     }
 
-    auto stream              = _baseStream;
-    const auto &hcaInfo      = _hcaInfo;
-    const auto waveBlockSize = GetWaveBlockSize();
-    auto channels            = _channels.cbegin();
+    const auto waveBlockBuffer = blockCache->Acquire();
+    DecodeBlockInto(blockIndex, waveBlockBuffer);
+    blockCache->Commit(blockIndex);
+    return waveBlockBuffer;
+}
+
+void CHcaDecoder::DecodeBlockInto(std::uint32_t blockIndex, std::uint8_t *waveBlockBuffer) {
+    const auto blockDecoder = _blockDecoder;
+    // After a seek, or when the block before was served from the cache, the overlap state belongs
+    // to some other block.
+    if (blockIndex != _nextBlockIndex) {
+        _nextBlockIndex = InvalidBlockIndex;
+        PreRoll(blockIndex, blockDecoder);
+    }
+    _nextBlockIndex = InvalidBlockIndex;
+    ReadBlock(blockIndex, blockDecoder);
+    blockDecoder->DecodeBlock();
+    blockDecoder->WriteWave(waveBlockBuffer);
+    _nextBlockIndex = blockIndex + 1;
+}
+
+void CHcaDecoder::DecodeBlocksPlanar(
+    std::uint32_t blockIndex, std::uint32_t blockCount, float *const *channelWaves
+) {
+    const auto &hcaInfo = _hcaInfo;
+    if (!channelWaves || blockIndex > hcaInfo.blockCount ||
+        blockCount > hcaInfo.blockCount - blockIndex) {
+        throw CArgumentException("CHcaDecoder::DecodeBlocksPlanar");
+    }
+    if (blockCount == 0) {
+        return;
+    }
+    for (std::uint32_t k = 0; k < hcaInfo.channelCount; ++k) {
+        if (!channelWaves[k]) {
+            throw CArgumentException("CHcaDecoder::DecodeBlocksPlanar");
+        }
+    }
 
-    auto hcaBlockBuffer = _hcaBlockBuffer ? _hcaBlockBuffer : new std::uint8_t[hcaInfo.blockSize];
-    _hcaBlockBuffer     = hcaBlockBuffer;
+    const auto blockDecoder = _blockDecoder;
+    if (blockIndex != _nextBlockIndex) {
+        _nextBlockIndex = InvalidBlockIndex;
+        PreRoll(blockIndex, blockDecoder);
+    }
 
-    stream->Seek(hcaInfo.dataOffset + hcaInfo.blockSize * blockIndex, StreamSeekOrigin::Begin);
-    auto actualRead = stream->Read(hcaBlockBuffer, hcaInfo.blockSize, 0, hcaInfo.blockSize);
-    if (actualRead < hcaInfo.blockSize) {
-        throw CException(OpResult::DecodeFailed);
+    std::array<float *, 0x10> blockWaves = {};
+    for (std::uint32_t i = 0; i < blockCount; ++i) {
+        const auto sampleOffset = static_cast<std::size_t>(i) * blockDecoder->GetFrameCount();
+        for (std::uint32_t k = 0; k < hcaInfo.channelCount; ++k) {
+            blockWaves[k] = channelWaves[k] + sampleOffset;
+        }
+        _nextBlockIndex = InvalidBlockIndex;
+        ReadBlock(blockIndex + i, blockDecoder);
+        blockDecoder->DecodeBlock();
+        blockDecoder->WritePlanar(blockWaves.data());
+        _nextBlockIndex = blockIndex + i + 1;
+    }
+}
+
+void CHcaDecoder::ReadBlock(std::uint32_t blockIndex, CHcaBlockDecoder *blockDecoder) {
+    auto stream          = _baseStream;
+    const auto &hcaInfo  = _hcaInfo;
+    const auto blockData = blockDecoder->GetBlockBuffer();
+
+    {
+        std::lock_guard<std::mutex> lock(_streamMutex);
+        stream->Seek(
+            hcaInfo.dataOffset + static_cast<std::uint64_t>(hcaInfo.blockSize) * blockIndex,
+            StreamSeekOrigin::Begin
+        );
+        auto actualRead = stream->Read(blockData, hcaInfo.blockSize, 0, hcaInfo.blockSize);
+        if (actualRead < hcaInfo.blockSize) {
+            throw CException(OpResult::DecodeFailed);
+        }
     }
 
     // Compute block checksum.
-    if (ComputeChecksum(hcaBlockBuffer, hcaInfo.blockSize, 0) != 0) {
+    if (IsChecksumVerified(blockIndex) && ComputeChecksum(blockData, hcaInfo.blockSize, 0) != 0) {
         throw CException(OpResult::ChecksumError);
     }
+}
 
-    // Decrypt block if needed.
-    _cipher->Decrypt(hcaBlockBuffer, hcaInfo.blockSize);
-
-    CHcaData data(hcaBlockBuffer, hcaInfo.blockSize, hcaInfo.blockSize);
+auto CHcaDecoder::IsChecksumVerified(std::uint32_t blockIndex) const -> bool_t {
+    const auto blockCount = _decoderConfig.checksumBlockCount;
+    switch (_decoderConfig.checksumPolicy) {
+    case HcaChecksumPolicy::FirstBlocks:
+        return static_cast<bool_t>(blockIndex < blockCount);
+    case HcaChecksumPolicy::Sampled:
+        return static_cast<bool_t>(blockCount == 0 || blockIndex % blockCount == 0);
+    case HcaChecksumPolicy::Never:
+        return FALSE;
+    default:
+        return TRUE;
+    }
+}
 
-    const auto magic = data.GetBit(16);
-    if (magic != 0xffff) {
-        throw CException(OpResult::DecodeFailed);
+auto CHcaDecoder::VerifyBlocks() -> bool_t {
+    const auto &hcaInfo       = _hcaInfo;
+    const auto blockSize      = hcaInfo.blockSize;
+    const auto blockCount     = hcaInfo.blockCount;
+    const auto maxChunkBlocks = std::min(blockCount, VerifyChunkBlockCount);
+    std::vector<std::uint8_t> buffer(static_cast<std::size_t>(maxChunkBlocks) * blockSize);
+
+    // Read several blocks at a time, whatever the checksum policy.
+    for (std::uint32_t blockIndex = 0; blockIndex < blockCount;) {
+        const auto chunkBlocks = std::min(blockCount - blockIndex, maxChunkBlocks);
+        const auto chunkSize   = static_cast<std::size_t>(chunkBlocks) * blockSize;
+        {
+            std::lock_guard<std::mutex> lock(_streamMutex);
+            _baseStream->Seek(
+                hcaInfo.dataOffset + static_cast<std::uint64_t>(blockSize) * blockIndex,
+                StreamSeekOrigin::Begin
+            );
+            if (_baseStream->Read(buffer.data(), chunkSize, 0, chunkSize) < chunkSize) {
+                // Truncated.
+                return FALSE;
+            }
+        }
+        for (std::uint32_t i = 0; i < chunkBlocks; ++i) {
+            const auto block = buffer.data() + static_cast<std::size_t>(i) * blockSize;
+            if (ComputeChecksum(block, blockSize, 0) != 0) {
+                return FALSE;
+            }
+        }
+        blockIndex += chunkBlocks;
     }
+    return TRUE;
+}
 
-    // Actual decoding process.
-    auto a = (data.GetBit(9) << 8u) - data.GetBit(7);
-    for (std::uint32_t i = 0; i < hcaInfo.channelCount; ++i) {
-        CHcaChannel::Decode1(*(channels + i), &data, hcaInfo.compR09, a, _ath->GetTable());
+void CHcaDecoder::PreRoll(std::uint32_t blockIndex, CHcaBlockDecoder *blockDecoder) {
+    blockDecoder->Reset();
+    if (blockIndex == 0) {
+        return;
     }
-    for (auto i = 0; i < 8; ++i) {
-        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
-            CHcaChannel::Decode2(*(channels + j), &data);
+
+    // Walk back to a block whose state does not depend on earlier blocks. The overlap state it
+    // leaves behind is discarded, since the block after it is decoded again.
+    auto first = blockIndex - 1;
+    while (true) {
+        ReadBlock(first, blockDecoder);
+        blockDecoder->DecodeBlock();
+        if (first == 0 || !blockDecoder->DependsOnPreviousBlock()) {
+            break;
         }
-        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
-            CHcaChannel::Decode3(
-                *(channels + j),
-                hcaInfo.compR09,
-                hcaInfo.compR08,
-                hcaInfo.compR07 + hcaInfo.compR06,
-                hcaInfo.compR05
+        --first;
+    }
+    if (first == 0 && blockDecoder->DependsOnPreviousBlock()) {
+        // The first block of the file reads the initial state, so decode it again from there.
+        blockDecoder->Reset();
+        ReadBlock(0, blockDecoder);
+        blockDecoder->DecodeBlock();
+    }
+    for (auto i = first + 1; i < blockIndex; ++i) {
+        ReadBlock(i, blockDecoder);
+        blockDecoder->DecodeBlock();
+    }
+}
+
+void CHcaDecoder::DecodeBlocks(
+    std::uint32_t blockIndex, std::uint32_t blockCount, void *buffer, std::size_t bufferSize,
+    std::uint32_t threadCount
+) {
+    const auto &hcaInfo      = _hcaInfo;
+    const auto waveBlockSize = GetWaveBlockSize();
+    if (!buffer || blockIndex > hcaInfo.blockCount ||
+        blockCount > hcaInfo.blockCount - blockIndex ||
+        bufferSize < static_cast<std::uint64_t>(blockCount) * waveBlockSize) {
+        throw CArgumentException("CHcaDecoder::DecodeBlocks");
+    }
+    if (blockCount == 0) {
+        return;
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    const auto maxSegmentCount = (blockCount + MinSegmentBlockCount - 1) / MinSegmentBlockCount;
+    const auto segmentCount    = std::min(threadCount, maxSegmentCount);
+    const auto byteBuffer      = static_cast<std::uint8_t *>(buffer);
+
+    // Segment sizes differ by at most one block.
+    auto getSegmentStart = [&](std::size_t segment) {
+        return static_cast<std::uint32_t>(
+            static_cast<std::uint64_t>(blockCount) * segment / segmentCount
+        );
+    };
+    CTaskRunner::Run(
+        segmentCount,
+        segmentCount,
+        [&](std::size_t segment, const std::atomic<bool> &cancelled) {
+            const auto start = getSegmentStart(segment);
+            const auto end   = getSegmentStart(segment + 1);
+            DecodeSegment(
+                blockIndex + start, end - start,
+                byteBuffer + static_cast<std::size_t>(start) * waveBlockSize, cancelled
             );
         }
-        for (std::uint32_t j = 0; j < hcaInfo.channelCount - 1; ++j) {
-            CHcaChannel::Decode4(
-                *(channels + j),
-                *(channels + j + 1),
-                i,
-                hcaInfo.compR05 - hcaInfo.compR06,
-                hcaInfo.compR06,
-                hcaInfo.compR07
-            );
+    );
+}
+
+auto CHcaDecoder::ValidateKeys(
+    IStream *stream, const std::vector<HCA_CIPHER_CONFIG> &candidates, std::uint32_t threadCount
+) -> std::vector<bool_t> {
+    std::vector<bool_t> results(candidates.size(), FALSE);
+    if (!stream || candidates.empty()) {
+        return results;
+    }
+
+    try {
+        // Only parses the header and reads raw blocks. Its own key is never used.
+        CHcaDecoderConfig decoderConfig;
+        decoderConfig.streamingEnabled = TRUE;
+        CHcaDecoder decoder(stream, decoderConfig);
+
+        const auto &hcaInfo  = decoder._hcaInfo;
+        const auto athTable  = decoder._ath->GetTable();
+        const auto blockSize = hcaInfo.blockSize;
+
+        // Collect the first non-blank blocks. The sync word and the checksum are left out of the
+        // test, since blank blocks read the same under every key.
+        std::vector<std::uint8_t> blocks;
+        std::uint32_t blockCount = 0;
+        for (std::uint32_t i = 0; i < hcaInfo.blockCount && blockCount < KeyValidationBlockCount;
+             ++i) {
+            decoder.ReadBlock(i, decoder._blockDecoder);
+            const auto block = decoder._blockDecoder->GetBlockBuffer();
+            if (std::any_of(block + 2, block + blockSize - 2, [](std::uint8_t b) {
+                    return b != 0;
+                })) {
+                blocks.insert(blocks.end(), block, block + blockSize);
+                ++blockCount;
+            }
         }
-        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
-            CHcaChannel::Decode5(*(channels + j), i);
+        if (blockCount == 0) {
+            results.assign(candidates.size(), TRUE);
+            return results;
         }
-    }
 
-    // Generate wave data.
-    const auto waveBlockBuffer = new std::uint8_t[waveBlockSize];
-    const auto decodeFunc      = _decoderConfig.decodeFunc;
-    std::uint32_t cursor       = 0;
-    if (decodeFunc) {
-        for (auto i = 0; i < 8; ++i) {
-            for (auto j = 0; j < 0x80; ++j) {
-                for (std::uint32_t k = 0; k < hcaInfo.channelCount; ++k) {
-                    auto f = channels[k]->wave[i][j] * hcaInfo.rvaVolume;
-                    f      = std::clamp(f, -1.0f, 1.0f);
-                    cursor = decodeFunc(f, waveBlockBuffer, cursor);
+        auto validate = [&](const HCA_CIPHER_CONFIG &candidate) -> bool_t {
+            // The same cipher as a decoder configured with this key. Its tables are built here
+            // rather than taken from the shared cache, so that trying many keys does not evict the
+            // tables of the decoders in use.
+            auto cipherConfig       = candidate;
+            cipherConfig.cipherType = hcaInfo.cipherType;
+            const auto cipher       = CHcaCipher::CreateUnshared(cipherConfig);
+            CHcaBlockDecoder blockDecoder(
+                hcaInfo, athTable, &cipher, HcaWaveFormat::Default, nullptr, HcaDecodeQuality::Full
+            );
+            for (std::uint32_t i = 0; i < blockCount; ++i) {
+                const auto block = blocks.data() + static_cast<std::size_t>(i) * blockSize;
+                std::memcpy(blockDecoder.GetBlockBuffer(), block, blockSize);
+                if (!blockDecoder.VerifyBlock()) {
+                    return FALSE;
                 }
             }
-        }
+            return TRUE;
+        };
+
+        CTaskRunner::Run(candidates.size(), threadCount, [&](std::size_t i, const auto &) {
+            try {
+                results[i] = validate(candidates[i]);
+            } catch (...) {
+                results[i] = FALSE;
+            }
+        });
+    } catch (...) {
+        // Not an HCA file, or a block could not be read.
+        results.assign(candidates.size(), FALSE);
     }
 
-    decodedBlocks[blockIndex] = waveBlockBuffer;
-    return waveBlockBuffer;
+    return results;
+}
+
+void CHcaDecoder::DecodeSegment(
+    std::uint32_t blockIndex, std::uint32_t blockCount, std::uint8_t *buffer,
+    const std::atomic<bool> &cancelled
+) {
+    CHcaBlockDecoder blockDecoder(
+        _hcaInfo,
+        _ath->GetTable(),
+        _cipher,
+        _waveFormat,
+        _decoderConfig.decodeFunc,
+        _decoderConfig.decodeQuality
+    );
+
+    PreRoll(blockIndex, &blockDecoder);
+
+    const auto waveBlockSize = GetWaveBlockSize();
+    for (std::uint32_t i = 0; i < blockCount && !cancelled; ++i) {
+        ReadBlock(blockIndex + i, &blockDecoder);
+        blockDecoder.DecodeBlock();
+        blockDecoder.WriteWave(buffer + static_cast<std::size_t>(i) * waveBlockSize);
+    }
 }
 
 auto CHcaDecoder::GetPosition() -> std::uint64_t {
@@ -348,6 +709,28 @@ auto CHcaDecoder::GetPosition() -> std::uint64_t {
 
 void CHcaDecoder::SetPosition(std::uint64_t value) {
     _position = value;
+
+    // Looping forever makes MapLoopedPosition() throw past the first loop. Leave that to Read(),
+    // since setting the position never threw.
+    const auto loopsForever = _hcaInfo.loopExists && _decoderConfig.loopEnabled &&
+                              _decoderConfig.loopCount == 0;
+    if (_prefetcher && !loopsForever) {
+        // Let the worker start on the new position before the next Read() asks for it.
+        const auto waveHeaderSize = _decoderConfig.waveHeaderEnabled ? GetWaveHeaderSize() : 0;
+        const auto mappedPosition = MapLoopedPosition(value);
+        if (mappedPosition >= waveHeaderSize) {
+            const auto blockIndex = (mappedPosition - waveHeaderSize) / GetWaveBlockSize();
+            if (blockIndex < _hcaInfo.blockCount) {
+                _prefetcher->Seek(static_cast<std::uint32_t>(blockIndex));
+            }
+        }
+    }
+}
+
+void CHcaDecoder::SeekToSample(std::uint64_t sampleIndex) {
+    const auto waveHeaderSize = _decoderConfig.waveHeaderEnabled ? GetWaveHeaderSize() : 0;
+    const auto frameSize      = static_cast<std::uint64_t>(GetSampleSize()) * _hcaInfo.channelCount;
+    SetPosition(waveHeaderSize + sampleIndex * frameSize);
 }
 
 auto CHcaDecoder::MapLoopedPosition(std::uint64_t linearPosition) -> std::uint64_t {
@@ -445,7 +828,6 @@ auto CHcaDecoder::Read(void *buffer, std::size_t bufferSize, std::size_t offset,
         const auto blockIndex =
             static_cast<std::uint32_t>((mappedPosition - waveHeaderSize) / waveBlockSize);
         const auto startOffset = (mappedPosition - waveHeaderSize) % waveBlockSize;
-        const auto blockData   = DecodeBlock(blockIndex);
         const auto copyLength  = std::min(
             waveStreamLength - mappedPosition,
             std::min(
@@ -453,9 +835,16 @@ auto CHcaDecoder::Read(void *buffer, std::size_t bufferSize, std::size_t offset,
                 static_cast<std::uint64_t>(bufferSize)
             )
         );
-        std::memcpy(
-            byteBuffer + offset, blockData + startOffset, static_cast<std::size_t>(copyLength)
-        );
+        if (!_prefetcher && decoderConfig.streamingEnabled && copyLength == waveBlockSize &&
+            blockIndex != _streamBlockIndex) {
+            // The whole block fits, so skip the intermediate buffer.
+            DecodeBlockInto(blockIndex, byteBuffer + offset);
+        } else {
+            const auto blockData = DecodeBlock(blockIndex);
+            std::memcpy(
+                byteBuffer + offset, blockData + startOffset, static_cast<std::size_t>(copyLength)
+            );
+        }
         streamPosition += copyLength;
         bufferSize -= copyLength;
         offset += copyLength;
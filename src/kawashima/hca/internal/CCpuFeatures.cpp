@@ -0,0 +1,85 @@
+#include <array>
+#include <cstdint>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#include "./CCpuFeatures.h"
+
+#if defined(ACB_ARCH_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+ACB_NS_BEGIN
+
+struct CpuFeatureSet {
+    bool_t sse2;
+    bool_t pclmul;
+    bool_t avx2;
+    bool_t avx512Vbmi;
+};
+
+static auto DetectCpuFeatures() -> CpuFeatureSet {
+    CpuFeatureSet features = {};
+#if defined(ACB_ARCH_X86) && defined(__GNUC__)
+    // libgcc also checks that the OS saves the extended registers before reporting AVX features.
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2") ? TRUE : FALSE;
+    features.avx2 = __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+    features.pclmul =
+        __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3") ? TRUE : FALSE;
+    features.avx512Vbmi =
+        __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi") ? TRUE : FALSE;
+#elif defined(ACB_ARCH_X86) && defined(_MSC_VER)
+    std::array<int, 4> info = {};
+    __cpuid(info.data(), 0);
+    const auto maxLeaf = info[0];
+
+    __cpuid(info.data(), 1);
+    const auto ecx1 = static_cast<std::uint32_t>(info[2]);
+    const auto edx1 = static_cast<std::uint32_t>(info[3]);
+    features.sse2   = (edx1 >> 26u) & 1u;
+    features.pclmul = ((ecx1 >> 1u) & 1u) && ((ecx1 >> 9u) & 1u);
+
+    const auto osXsave    = (ecx1 >> 27u) & 1u;
+    const auto xcr0       = osXsave ? _xgetbv(0) : 0;
+    const auto osSavesYmm = (xcr0 & 0x6u) == 0x6u;
+    // Opmask and both halves of the upper ZMM registers as well.
+    const auto osSavesZmm = (xcr0 & 0xe6u) == 0xe6u;
+    if (maxLeaf >= 7 && osSavesYmm) {
+        __cpuidex(info.data(), 7, 0);
+        const auto ebx7 = static_cast<std::uint32_t>(info[1]);
+        const auto ecx7 = static_cast<std::uint32_t>(info[2]);
+        features.avx2   = (ebx7 >> 5u) & 1u;
+        if (osSavesZmm) {
+            const auto avx512Bw = ((ebx7 >> 16u) & 1u) && ((ebx7 >> 30u) & 1u);
+            features.avx512Vbmi = avx512Bw && ((ecx7 >> 1u) & 1u);
+        }
+    }
+#endif
+    return features;
+}
+
+static auto GetCpuFeatures() -> const CpuFeatureSet & {
+    static const CpuFeatureSet features = DetectCpuFeatures();
+    return features;
+}
+
+auto CCpuFeatures::HasSse2() -> bool_t {
+    return GetCpuFeatures().sse2;
+}
+
+auto CCpuFeatures::HasPclmul() -> bool_t {
+    return GetCpuFeatures().pclmul;
+}
+
+auto CCpuFeatures::HasAvx2() -> bool_t {
+    return GetCpuFeatures().avx2;
+}
+
+auto CCpuFeatures::HasAvx512Vbmi() -> bool_t {
+    return GetCpuFeatures().avx512Vbmi;
+}
+
+ACB_NS_END
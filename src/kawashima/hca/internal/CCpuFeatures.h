@@ -0,0 +1,48 @@
+#ifndef ACB_KAWASHIMA_HCA_CCPUFEATURES_H_
+#define ACB_KAWASHIMA_HCA_CCPUFEATURES_H_
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ACB_ARCH_X86
+#endif
+
+// Lets a single function use instructions beyond the compiler's baseline. MSVC accepts intrinsics
+// of any instruction set without it.
+#if defined(ACB_ARCH_X86) && defined(__GNUC__)
+#define ACB_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ACB_TARGET(isa)
+#endif
+
+ACB_NS_BEGIN
+
+/**
+ * Runtime detection of the instruction set extensions used by the SIMD kernels.
+ * @remarks All queries return FALSE on non-x86 targets. Results are computed once and cached.
+ */
+class CCpuFeatures final {
+
+public:
+    static auto HasSse2() -> bool_t;
+
+    /**
+     * Tells whether PCLMULQDQ can be used, along with the SSSE3 byte shuffles it is used with.
+     */
+    static auto HasPclmul() -> bool_t;
+
+    static auto HasAvx2() -> bool_t;
+
+    /**
+     * Tells whether AVX-512 VBMI can be used, along with the AVX-512 F and BW instructions it
+     * builds on.
+     */
+    static auto HasAvx512Vbmi() -> bool_t;
+
+    PURE_STATIC(CCpuFeatures);
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CCPUFEATURES_H_
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "acb_env_ns.h"
+
+#include "./CHcaBlockCache.h"
+
+ACB_NS_BEGIN
+
+CHcaBlockCache::CHcaBlockCache(
+    std::uint32_t blockCount, std::uint32_t blockSize, std::uint32_t capacity
+)
+    : _blockSize(blockSize), _capacity(std::max(capacity, 1u)),
+      _blockSlots(blockCount, InvalidSlot), _head(InvalidSlot), _tail(InvalidSlot),
+      _pendingSlot(InvalidSlot) {
+    _slots.reserve(_capacity);
+    _slabs.reserve((_capacity + SlabBlockCount - 1) / SlabBlockCount);
+    _slabBlockCounts.reserve(_slabs.capacity());
+}
+
+CHcaBlockCache::~CHcaBlockCache() {
+    for (const auto slab : _slabs) {
+        delete[] slab;
+    }
+    _slabs.clear();
+    _slabBlockCounts.clear();
+}
+
+auto CHcaBlockCache::Find(std::uint32_t blockIndex) -> const std::uint8_t * {
+    if (blockIndex >= _blockSlots.size()) {
+        return nullptr;
+    }
+    const auto slot = _blockSlots[blockIndex];
+    if (slot == InvalidSlot) {
+        return nullptr;
+    }
+    if (slot != _head) {
+        Unlink(slot);
+        LinkFront(slot);
+    }
+    return GetSlotData(slot);
+}
+
+auto CHcaBlockCache::Acquire() -> std::uint8_t * {
+    if (_pendingSlot != InvalidSlot) {
+        return GetSlotData(_pendingSlot);
+    }
+
+    std::uint32_t slot;
+    if (_slots.size() < _capacity) {
+        // Still growing: hand out a fresh slot, allocating a new slab on slab boundaries.
+        slot = static_cast<std::uint32_t>(_slots.size());
+        if (slot % SlabBlockCount == 0) {
+            const auto slab           = slot / SlabBlockCount;
+            const auto slabBlockCount = std::min(SlabBlockCount, _capacity - slot);
+            if (slab == _slabs.size()) {
+                _slabs.push_back(nullptr);
+                _slabBlockCounts.push_back(0);
+            }
+            // Slabs left by Reset() are reused when large enough.
+            if (_slabBlockCounts[slab] < slabBlockCount) {
+                delete[] _slabs[slab];
+                _slabs[slab]           = nullptr;
+                _slabBlockCounts[slab] = 0;
+                _slabs[slab] =
+                    new std::uint8_t[static_cast<std::size_t>(slabBlockCount) * _blockSize];
+                _slabBlockCounts[slab] = slabBlockCount;
+            }
+        }
+        _slots.push_back({InvalidSlot, InvalidSlot, InvalidSlot});
+    } else {
+        // Full: recycle the least recently used slot.
+        slot = _tail;
+        Unlink(slot);
+        if (_slots[slot].blockIndex != InvalidSlot) {
+            _blockSlots[_slots[slot].blockIndex] = InvalidSlot;
+            _slots[slot].blockIndex              = InvalidSlot;
+        }
+    }
+
+    _pendingSlot = slot;
+    return GetSlotData(slot);
+}
+
+void CHcaBlockCache::Commit(std::uint32_t blockIndex) {
+    const auto slot = _pendingSlot;
+    if (slot == InvalidSlot || blockIndex >= _blockSlots.size()) {
+        return;
+    }
+    _pendingSlot            = InvalidSlot;
+    _slots[slot].blockIndex = blockIndex;
+    _blockSlots[blockIndex] = slot;
+    LinkFront(slot);
+}
+
+void CHcaBlockCache::Reset(
+    std::uint32_t blockCount, std::uint32_t blockSize, std::uint32_t capacity
+) {
+    if (blockSize > _blockSize) {
+        // Blocks no longer fit in the slabs.
+        for (const auto slab : _slabs) {
+            delete[] slab;
+        }
+        _slabs.clear();
+        _slabBlockCounts.clear();
+        _blockSize = blockSize;
+    }
+    _capacity = std::max(capacity, 1u);
+    _blockSlots.assign(blockCount, InvalidSlot);
+    _slots.clear();
+    _head = _tail = InvalidSlot;
+    _pendingSlot  = InvalidSlot;
+}
+
+auto CHcaBlockCache::GetSlotData(std::uint32_t slot) const -> std::uint8_t * {
+    return _slabs[slot / SlabBlockCount] +
+           static_cast<std::size_t>(slot % SlabBlockCount) * _blockSize;
+}
+
+void CHcaBlockCache::Unlink(std::uint32_t slot) {
+    auto &s = _slots[slot];
+    if (s.prev != InvalidSlot) {
+        _slots[s.prev].next = s.next;
+    } else {
+        _head = s.next;
+    }
+    if (s.next != InvalidSlot) {
+        _slots[s.next].prev = s.prev;
+    } else {
+        _tail = s.prev;
+    }
+    s.prev = s.next = InvalidSlot;
+}
+
+void CHcaBlockCache::LinkFront(std::uint32_t slot) {
+    auto &s = _slots[slot];
+    s.prev  = InvalidSlot;
+    s.next  = _head;
+    if (_head != InvalidSlot) {
+        _slots[_head].prev = slot;
+    }
+    _head = slot;
+    if (_tail == InvalidSlot) {
+        _tail = slot;
+    }
+}
+
+ACB_NS_END
@@ -0,0 +1,88 @@
+#ifndef ACB_KAWASHIMA_HCA_CHCABLOCKCACHE_H_
+#define ACB_KAWASHIMA_HCA_CHCABLOCKCACHE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "acb_env_ns.h"
+
+ACB_NS_BEGIN
+
+/**
+ * A bounded LRU cache of decoded wave blocks.
+ * @remarks Block storage is carved from slabs which are allocated once and reused afterwards, so
+ * evicting a block never touches the heap.
+ */
+class CHcaBlockCache {
+
+public:
+    CHcaBlockCache(std::uint32_t blockCount, std::uint32_t blockSize, std::uint32_t capacity);
+
+    CHcaBlockCache(const CHcaBlockCache &) = delete;
+
+    auto operator=(const CHcaBlockCache &) -> CHcaBlockCache & = delete;
+
+    ~CHcaBlockCache();
+
+    /**
+     * Looks up a decoded block and marks it as the most recently used one.
+     * @param blockIndex Index of the block.
+     * @return The cached block data, or nullptr if the block is not cached.
+     */
+    auto Find(std::uint32_t blockIndex) -> const std::uint8_t *;
+
+    /**
+     * Reserves storage for a block which is about to be decoded, evicting the least recently used
+     * block if the cache is full.
+     * @remarks The storage is not visible to Find() until Commit() is called.
+     * @return The reserved storage.
+     */
+    auto Acquire() -> std::uint8_t *;
+
+    /**
+     * Publishes the storage returned by the last Acquire() call as the data of a block.
+     * @param blockIndex Index of the block.
+     */
+    void Commit(std::uint32_t blockIndex);
+
+    /**
+     * Drops all cached blocks and changes the cache geometry, as if the cache was constructed
+     * again. Slabs are kept for reuse as long as blocks still fit in them.
+     * @param blockCount Total number of blocks.
+     * @param blockSize Size of each block.
+     * @param capacity Maximum number of cached blocks, at least 1.
+     */
+    void Reset(std::uint32_t blockCount, std::uint32_t blockSize, std::uint32_t capacity);
+
+private:
+    struct CacheSlot {
+        std::uint32_t blockIndex;
+        std::uint32_t prev;
+        std::uint32_t next;
+    };
+
+    static constexpr std::uint32_t InvalidSlot    = 0xffffffff;
+    static constexpr std::uint32_t SlabBlockCount = 0x10;
+
+    auto GetSlotData(std::uint32_t slot) const -> std::uint8_t *;
+
+    void Unlink(std::uint32_t slot);
+
+    void LinkFront(std::uint32_t slot);
+
+    // Distance between blocks in a slab. Only grows, so that slabs stay reusable after Reset().
+    std::uint32_t _blockSize;
+    std::uint32_t _capacity;
+    std::vector<std::uint32_t> _blockSlots;
+    std::vector<CacheSlot> _slots;
+    std::vector<std::uint8_t *> _slabs;
+    // Number of blocks each slab can hold.
+    std::vector<std::uint32_t> _slabBlockCounts;
+    std::uint32_t _head;
+    std::uint32_t _tail;
+    std::uint32_t _pendingSlot;
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CHCABLOCKCACHE_H_
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "acb_enum.h"
+#include "acb_env_ns.h"
+#include "takamori/exceptions/CArgumentException.h"
+
+#include "./CHcaBlockDecoder.h"
+#include "./CHcaChannel.h"
+#include "./CHcaCipher.h"
+#include "./CHcaData.h"
+
+ACB_NS_BEGIN
+
+// Decodes the channels of a block, from the scale factors on, for any channel layout.
+static void DecodeChannels(
+    CHcaChannel *const *channels, CHcaData *data, const HCA_INFO &hcaInfo,
+    const std::uint8_t *athTable, std::int32_t a
+) {
+    for (std::uint32_t i = 0; i < hcaInfo.channelCount; ++i) {
+        if (!CHcaChannel::Decode1(channels[i], data, hcaInfo.compR09, a, athTable)) {
+            throw CException(OpResult::DecodeFailed);
+        }
+    }
+    for (auto i = 0; i < 8; ++i) {
+        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
+            CHcaChannel::Decode2(channels[j], data);
+        }
+        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
+            CHcaChannel::Decode3(
+                channels[j],
+                hcaInfo.compR09,
+                hcaInfo.compR08,
+                hcaInfo.compR07 + hcaInfo.compR06,
+                hcaInfo.compR05
+            );
+        }
+        for (std::uint32_t j = 0; j < hcaInfo.channelCount - 1; ++j) {
+            CHcaChannel::Decode4(
+                channels[j],
+                channels[j + 1],
+                i,
+                hcaInfo.compR05 - hcaInfo.compR06,
+                hcaInfo.compR06,
+                hcaInfo.compR07
+            );
+        }
+        CHcaChannel::Decode5Channels(channels, hcaInfo.channelCount, i);
+    }
+}
+
+/**
+ * DecodeChannels() for one or two channels of types Type0 and Type1, where every loop over channels
+ * and every check on their types is resolved at compile time.
+ */
+template<std::uint32_t ChannelCount, std::int32_t Type0, std::int32_t Type1 = 0>
+static void DecodeChannelsFixed(
+    CHcaChannel *const *channels, CHcaData *data, const HCA_INFO &hcaInfo,
+    const std::uint8_t *athTable, std::int32_t a
+) {
+    static_assert(ChannelCount == 1 || ChannelCount == 2);
+
+    auto valid = CHcaChannel::Decode1<Type0>(channels[0], data, hcaInfo.compR09, a, athTable);
+    if constexpr (ChannelCount == 2) {
+        valid = valid &&
+                CHcaChannel::Decode1<Type1>(channels[1], data, hcaInfo.compR09, a, athTable);
+    }
+    if (!valid) {
+        throw CException(OpResult::DecodeFailed);
+    }
+
+    const auto highBandCount = hcaInfo.compR07 + hcaInfo.compR06;
+    for (auto i = 0; i < 8; ++i) {
+        for (std::uint32_t j = 0; j < ChannelCount; ++j) {
+            CHcaChannel::Decode2(channels[j], data);
+        }
+        CHcaChannel::Decode3<Type0>(
+            channels[0], hcaInfo.compR09, hcaInfo.compR08, highBandCount, hcaInfo.compR05
+        );
+        if constexpr (ChannelCount == 2) {
+            CHcaChannel::Decode3<Type1>(
+                channels[1], hcaInfo.compR09, hcaInfo.compR08, highBandCount, hcaInfo.compR05
+            );
+            CHcaChannel::Decode4<Type0>(
+                channels[0],
+                channels[1],
+                i,
+                hcaInfo.compR05 - hcaInfo.compR06,
+                hcaInfo.compR06,
+                hcaInfo.compR07
+            );
+        }
+        for (std::uint32_t j = 0; j < ChannelCount; ++j) {
+            CHcaChannel::Decode5(channels[j], i);
+        }
+    }
+}
+
+/**
+ * DecodeChannels() for the preview qualities: the high bands are not reconstructed (Decode3), and
+ * with HalfRate, only the lower half of the spectrum is transformed back.
+ * @remarks Intensity stereo is still split, since it is cheap and the second channel of a pair
+ * would be silent without it.
+ */
+template<bool_t HalfRate>
+static void DecodeChannelsPreview(
+    CHcaChannel *const *channels, CHcaData *data, const HCA_INFO &hcaInfo,
+    const std::uint8_t *athTable, std::int32_t a
+) {
+    for (std::uint32_t i = 0; i < hcaInfo.channelCount; ++i) {
+        if (!CHcaChannel::Decode1(channels[i], data, hcaInfo.compR09, a, athTable)) {
+            throw CException(OpResult::DecodeFailed);
+        }
+    }
+    for (auto i = 0; i < 8; ++i) {
+        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
+            CHcaChannel::Decode2(channels[j], data);
+        }
+        for (std::uint32_t j = 0; j < hcaInfo.channelCount - 1; ++j) {
+            CHcaChannel::Decode4(
+                channels[j],
+                channels[j + 1],
+                i,
+                hcaInfo.compR05 - hcaInfo.compR06,
+                hcaInfo.compR06,
+                hcaInfo.compR07
+            );
+        }
+        if constexpr (HalfRate) {
+            for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
+                CHcaChannel::Decode5Half(channels[j], i);
+            }
+        } else {
+            CHcaChannel::Decode5Channels(channels, hcaInfo.channelCount, i);
+        }
+    }
+}
+
+CHcaBlockDecoder::CHcaBlockDecoder(
+    const HCA_INFO &hcaInfo, const std::uint8_t *athTable, const CHcaCipher *cipher,
+    HcaWaveFormat waveFormat, HcaDecodeFunc decodeFunc, HcaDecodeQuality quality
+) {
+    _channels.fill(nullptr);
+    _blockBuffer     = nullptr;
+    _blockBufferSize = 0;
+    Reconfigure(hcaInfo, athTable, cipher, waveFormat, decodeFunc, quality);
+}
+
+void CHcaBlockDecoder::Reconfigure(
+    const HCA_INFO &hcaInfo, const std::uint8_t *athTable, const CHcaCipher *cipher,
+    HcaWaveFormat waveFormat, HcaDecodeFunc decodeFunc, HcaDecodeQuality quality
+) {
+    // Work out the channel types before changing anything, since unknown layouts throw.
+    std::array<std::uint8_t, 0x10> r = {};
+    std::uint32_t b                  = hcaInfo.channelCount / hcaInfo.compR03;
+    if (hcaInfo.compR07 && b > 1) {
+        auto c = r.begin();
+        for (auto i = 0; i < hcaInfo.compR03; ++i, c += b) {
+            switch (b) {
+            case 2:
+            case 3:
+                c[0] = 1;
+                c[1] = 2;
+                break;
+            case 4:
+                c[0] = 1;
+                c[1] = 2;
+                if (hcaInfo.compR04 == 0) {
+                    c[2] = 1;
+                    c[3] = 2;
+                }
+                break;
+            case 5:
+                c[0] = 1;
+                c[1] = 2;
+                if (hcaInfo.compR04 <= 2) {
+                    c[3] = 1;
+                    c[4] = 2;
+                }
+                break;
+            case 6:
+            case 7:
+                c[0] = 1;
+                c[1] = 2;
+                c[4] = 1;
+                c[5] = 2;
+                // Fall through
+            case 8:
+                c[6] = 1;
+                c[7] = 2;
+                break;
+            default:
+                throw CArgumentException();
+            }
+        }
+    }
+
+    _hcaInfo    = hcaInfo;
+    _athTable   = athTable;
+    _cipher     = cipher;
+    _decodeFunc = decodeFunc;
+
+    // Channels are only allocated when the channel count grows, and kept when it shrinks.
+    auto channel = _channels.begin();
+    for (std::uint32_t i = 0; i < hcaInfo.channelCount; ++i, ++channel) {
+        if (*channel) {
+            (*channel)->Clear();
+        } else {
+            *channel = new CHcaChannel();
+        }
+        (*channel)->type   = r[i];
+        (*channel)->value3 = &(*channel)->value[hcaInfo.compR06 + hcaInfo.compR07];
+        (*channel)->count  = hcaInfo.compR06 + ((r[i] != 2) ? hcaInfo.compR07 : 0);
+    }
+
+    if (hcaInfo.blockSize > _blockBufferSize) {
+        if (_blockBuffer) {
+            delete[] _blockBuffer;
+            _blockBuffer     = nullptr;
+            _blockBufferSize = 0;
+        }
+        _blockBuffer     = new std::uint8_t[hcaInfo.blockSize + CHcaData::PaddingSize];
+        _blockBufferSize = hcaInfo.blockSize;
+    }
+    // The zeroed padding lets CHcaData read past the end of the block. A larger buffer kept from
+    // an earlier file is zeroed as a whole, since the padding now starts earlier.
+    std::memset(_blockBuffer, 0, _blockBufferSize + CHcaData::PaddingSize);
+
+    // Mono, and stereo with or without intensity stereo, have their own instances.
+    _frameCount = BlockFrameCount;
+    if (quality == HcaDecodeQuality::PreviewHalfRate) {
+        _decodeChannelsFunc = DecodeChannelsPreview<TRUE>;
+        _frameCount         = BlockFrameCount / 2;
+    } else if (quality == HcaDecodeQuality::Preview) {
+        _decodeChannelsFunc = DecodeChannelsPreview<FALSE>;
+    } else if (hcaInfo.channelCount == 1) {
+        _decodeChannelsFunc = DecodeChannelsFixed<1, 0>;
+    } else if (hcaInfo.channelCount == 2 && r[0] == 0 && r[1] == 0) {
+        _decodeChannelsFunc = DecodeChannelsFixed<2, 0, 0>;
+    } else if (hcaInfo.channelCount == 2 && r[0] == 1 && r[1] == 2) {
+        _decodeChannelsFunc = DecodeChannelsFixed<2, 1, 2>;
+    } else {
+        _decodeChannelsFunc = DecodeChannels;
+    }
+
+    _waveWriteFunc = CHcaWaveWriter::GetWriteFunc(waveFormat, hcaInfo.channelCount);
+}
+
+CHcaBlockDecoder::~CHcaBlockDecoder() {
+    if (_blockBuffer) {
+        delete[] _blockBuffer;
+        _blockBuffer = nullptr;
+    }
+
+    for (auto &_channel : _channels) {
+        if (_channel) {
+            delete _channel;
+            _channel = nullptr;
+        }
+    }
+}
+
+auto CHcaBlockDecoder::GetBlockBuffer() -> std::uint8_t * {
+    return _blockBuffer;
+}
+
+void CHcaBlockDecoder::DecodeBlock() {
+    const auto &hcaInfo = _hcaInfo;
+
+    // Decrypt block if needed.
+    _cipher->Decrypt(_blockBuffer, hcaInfo.blockSize);
+
+    CHcaData data(_blockBuffer, hcaInfo.blockSize, hcaInfo.blockSize);
+
+    const auto magic = data.GetBit(16);
+    if (magic != 0xffff) {
+        throw CException(OpResult::DecodeFailed);
+    }
+
+    // Actual decoding process.
+    auto a = (data.GetBit(9) << 8u) - data.GetBit(7);
+    _decodeChannelsFunc(_channels.data(), &data, hcaInfo, _athTable, a);
+}
+
+auto CHcaBlockDecoder::VerifyBlock() -> bool_t {
+    const auto &hcaInfo = _hcaInfo;
+    const auto channels = _channels.cbegin();
+
+    _cipher->Decrypt(_blockBuffer, hcaInfo.blockSize);
+
+    CHcaData data(_blockBuffer, hcaInfo.blockSize, hcaInfo.blockSize);
+
+    if (data.GetBit(16) != 0xffff) {
+        return FALSE;
+    }
+
+    // Only unpack the bitstream: the bits read depend on the scale factors, but nothing after.
+    auto a = (data.GetBit(9) << 8u) - data.GetBit(7);
+    for (std::uint32_t i = 0; i < hcaInfo.channelCount; ++i) {
+        if (!CHcaChannel::Decode1(*(channels + i), &data, hcaInfo.compR09, a, _athTable)) {
+            return FALSE;
+        }
+    }
+    for (auto i = 0; i < 8; ++i) {
+        for (std::uint32_t j = 0; j < hcaInfo.channelCount; ++j) {
+            CHcaChannel::Decode2(*(channels + j), &data);
+        }
+    }
+
+    // The coded data must fit before the checksum, and encoders fill the bytes after it with zeros.
+    const auto bitCount = data.GetPosition();
+    if (bitCount > data.GetSize()) {
+        return FALSE;
+    }
+    const auto padding = _blockBuffer + (bitCount + 7) / 8;
+    const auto end     = _blockBuffer + hcaInfo.blockSize - 2;
+    return static_cast<bool_t>(std::all_of(padding, end, [](std::uint8_t b) {
+        return b == 0;
+    }));
+}
+
+void CHcaBlockDecoder::WriteWave(std::uint8_t *waveBlockBuffer) const {
+    const auto &hcaInfo = _hcaInfo;
+    const auto channels = _channels.cbegin();
+
+    if (_waveWriteFunc) {
+        std::array<const float *, ChannelCount> channelWaves = {};
+        for (std::uint32_t k = 0; k < hcaInfo.channelCount; ++k) {
+            channelWaves[k] = channels[k]->wave[0].data();
+        }
+        _waveWriteFunc(
+            channelWaves.data(),
+            hcaInfo.channelCount,
+            _frameCount,
+            hcaInfo.rvaVolume,
+            waveBlockBuffer
+        );
+        return;
+    }
+
+    const auto decodeFunc = _decodeFunc;
+    std::uint32_t cursor  = 0;
+    if (decodeFunc) {
+        // The 8 sub-blocks of wave are contiguous.
+        for (std::uint32_t i = 0; i < _frameCount; ++i) {
+            for (std::uint32_t k = 0; k < hcaInfo.channelCount; ++k) {
+                auto f = channels[k]->wave[0].data()[i] * hcaInfo.rvaVolume;
+                f      = std::clamp(f, -1.0f, 1.0f);
+                cursor = decodeFunc(f, waveBlockBuffer, cursor);
+            }
+        }
+    }
+}
+
+void CHcaBlockDecoder::WritePlanar(float *const *channelWaves) const {
+    const auto volume = _hcaInfo.rvaVolume;
+    for (std::uint32_t k = 0; k < _hcaInfo.channelCount; ++k) {
+        // The 8 sub-blocks of wave are contiguous.
+        const auto wave = _channels[k]->wave[0].data();
+        const auto dest = channelWaves[k];
+        for (std::uint32_t i = 0; i < _frameCount; ++i) {
+            dest[i] = wave[i] * volume;
+        }
+    }
+}
+
+auto CHcaBlockDecoder::GetFrameCount() const -> std::uint32_t {
+    return _frameCount;
+}
+
+auto CHcaBlockDecoder::DependsOnPreviousBlock() const -> bool_t {
+    for (std::uint32_t i = 0; i < _hcaInfo.channelCount; ++i) {
+        // Decode1 leaves value2[1..7] untouched when value2[0] reads 15.
+        const auto channel = _channels[i];
+        if (channel->type == 2 && channel->value2[0] == 15) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void CHcaBlockDecoder::Reset() {
+    for (std::uint32_t i = 0; i < _hcaInfo.channelCount; ++i) {
+        const auto channel = _channels[i];
+        channel->value2.fill(0);
+        channel->wav3.fill(0);
+    }
+}
+
+ACB_NS_END
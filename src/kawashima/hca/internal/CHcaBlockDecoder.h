@@ -0,0 +1,140 @@
+#ifndef ACB_KAWASHIMA_HCA_CHCABLOCKDECODER_H_
+#define ACB_KAWASHIMA_HCA_CHCABLOCKDECODER_H_
+
+#include <array>
+#include <cstdint>
+
+#include "acb_cdata.h"
+#include "acb_enum.h"
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#include "./CHcaWaveWriter.h"
+
+ACB_NS_BEGIN
+
+class CHcaChannel;
+class CHcaCipher;
+class CHcaData;
+
+/**
+ * Decodes HCA blocks one at a time into wave data.
+ * @remarks Two kinds of state are carried from one block to the next: the overlap buffer of each
+ * channel, and the intensity stereo values, which a block may reuse from the block before it (see
+ * DependsOnPreviousBlock()). Instances sharing the same ATH table and cipher can decode on
+ * different threads.
+ */
+class CHcaBlockDecoder final {
+
+public:
+    /**
+     * @param hcaInfo Information of the HCA file.
+     * @param athTable ATH table of the file. It must outlive this decoder.
+     * @param cipher Cipher of the file. It must outlive this decoder.
+     * @param waveFormat Format of wave data, or HcaWaveFormat::Default to write it with decodeFunc.
+     * @param decodeFunc Per-sample function used to write wave data.
+     * @param quality Decoding quality, which sets the number of frames per block.
+     */
+    CHcaBlockDecoder(
+        const HCA_INFO &hcaInfo, const std::uint8_t *athTable, const CHcaCipher *cipher,
+        HcaWaveFormat waveFormat, HcaDecodeFunc decodeFunc, HcaDecodeQuality quality
+    );
+
+    CHcaBlockDecoder(const CHcaBlockDecoder &) = delete;
+
+    auto operator=(const CHcaBlockDecoder &) -> CHcaBlockDecoder & = delete;
+
+    ~CHcaBlockDecoder();
+
+    /**
+     * Prepares the decoder for another file, as if it was constructed again with these arguments.
+     * @remarks Channels and the block buffer are reused, and only reallocated when the channel
+     * count or the block size grows.
+     * @see CHcaBlockDecoder()
+     */
+    void Reconfigure(
+        const HCA_INFO &hcaInfo, const std::uint8_t *athTable, const CHcaCipher *cipher,
+        HcaWaveFormat waveFormat, HcaDecodeFunc decodeFunc, HcaDecodeQuality quality
+    );
+
+    /**
+     * Gets the buffer that receives a raw HCA block before calling DecodeBlock().
+     * @remarks The buffer holds blockSize bytes, followed by zeroed padding required by CHcaData.
+     */
+    auto GetBlockBuffer() -> std::uint8_t *;
+
+    /**
+     * Decrypts and decodes the raw block in the block buffer.
+     * @remarks The block checksum is not verified here. The block buffer is decrypted in place.
+     */
+    void DecodeBlock();
+
+    /**
+     * Decrypts the raw block in the block buffer and tells whether it reads as a valid block: it
+     * starts with the sync word, its scale factors are in range, its coded data fits before the
+     * checksum and is followed by zeros only. Used to tell a right key from a wrong one.
+     * @remarks Nothing is decoded, but the state carried between blocks is no longer meaningful
+     * afterwards: call Reset() before decoding with this decoder. The block buffer is decrypted in
+     * place.
+     */
+    [[nodiscard]] auto VerifyBlock() -> bool_t;
+
+    /**
+     * Writes the wave data of the last decoded block.
+     * @param waveBlockBuffer Destination buffer.
+     */
+    void WriteWave(std::uint8_t *waveBlockBuffer) const;
+
+    /**
+     * Writes the samples of the last decoded block as planar floats, scaled by the RVA volume and
+     * not clamped.
+     * @param channelWaves Destination of each channel, GetFrameCount() samples each.
+     */
+    void WritePlanar(float *const *channelWaves) const;
+
+    /**
+     * Gets the number of frames written per block: BlockFrameCount, or half of it when decoding
+     * with HcaDecodeQuality::PreviewHalfRate.
+     */
+    [[nodiscard]] auto GetFrameCount() const -> std::uint32_t;
+
+    /**
+     * Tells whether the last decoded block reused the intensity stereo values of the block before
+     * it. If not, the state after decoding it does not depend on any earlier block.
+     */
+    [[nodiscard]] auto DependsOnPreviousBlock() const -> bool_t;
+
+    /**
+     * Clears the state carried between blocks, so that the next block is decoded as the first block
+     * of the file.
+     */
+    void Reset();
+
+    static constexpr std::uint32_t BlockFrameCount = 0x400;
+
+private:
+    static constexpr std::uint32_t ChannelCount = 0x10;
+
+    using DecodeChannelsFunc = void (*)(
+        CHcaChannel *const *channels, CHcaData *data, const HCA_INFO &hcaInfo,
+        const std::uint8_t *athTable, std::int32_t a
+    );
+
+    HCA_INFO _hcaInfo;
+    const std::uint8_t *_athTable;
+    const CHcaCipher *_cipher;
+    HcaDecodeFunc _decodeFunc;
+    // Whole-block sample converter replacing _decodeFunc, or nullptr to call it per sample.
+    HcaWaveWriteFunc _waveWriteFunc;
+    // Decodes the channels of a block after its header, specialized for the channel layout.
+    DecodeChannelsFunc _decodeChannelsFunc;
+    std::uint32_t _frameCount;
+    std::array<CHcaChannel *, ChannelCount> _channels;
+    std::uint8_t *_blockBuffer;
+    // Largest block size _blockBuffer can hold, without its padding.
+    std::uint32_t _blockBufferSize;
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CHCABLOCKDECODER_H_
@@ -0,0 +1,44 @@
+#include <cstdint>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#include "./CHcaBlockRecipher.h"
+#include "./CHcaChecksum.h"
+#include "./CHcaCipher.h"
+
+ACB_NS_BEGIN
+
+CHcaBlockRecipher::CHcaBlockRecipher(const CHcaCipher &cipherFrom, const CHcaCipher &cipherTo) {
+    _decryptTable            = cipherFrom.GetDecryptTable();
+    const auto &encryptTable = cipherTo.GetEncryptTable();
+    for (std::uint32_t i = 0; i < CHcaCipher::TableSize; ++i) {
+        _recipherTable[i] = encryptTable[_decryptTable[i]];
+    }
+}
+
+auto CHcaBlockRecipher::Verify(const std::uint8_t *block, std::uint32_t blockSize) const
+    -> bool_t {
+    if (blockSize < 2 || CHcaChecksum::Compute(block, blockSize) != 0) {
+        return FALSE;
+    }
+    // The plain text starts with 0xffff.
+    return static_cast<bool_t>(_decryptTable[block[0]] == 0xff && _decryptTable[block[1]] == 0xff);
+}
+
+auto CHcaBlockRecipher::Convert(std::uint8_t *block, std::uint32_t blockSize) const -> bool_t {
+    if (!Verify(block, blockSize)) {
+        return FALSE;
+    }
+
+    // The checksum is not enciphered.
+    const auto dataSize = blockSize - 2;
+    CHcaCipher::Substitute(_recipherTable, block, dataSize);
+
+    const auto checksum = CHcaChecksum::Compute(block, dataSize);
+    block[dataSize]     = static_cast<std::uint8_t>(checksum >> 8u);
+    block[dataSize + 1] = static_cast<std::uint8_t>(checksum);
+    return TRUE;
+}
+
+ACB_NS_END
@@ -0,0 +1,55 @@
+#ifndef ACB_KAWASHIMA_HCA_CHCABLOCKRECIPHER_H_
+#define ACB_KAWASHIMA_HCA_CHCABLOCKRECIPHER_H_
+
+#include <array>
+#include <cstdint>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#include "./CHcaCipher.h"
+
+ACB_NS_BEGIN
+
+/**
+ * Re-enciphers HCA blocks from one cipher to another in place.
+ * @remarks Decrypting with the source cipher and encrypting with the target cipher are composed
+ * into a single substitution table, so each block is transformed in one pass. The checksum is
+ * verified and rewritten right before and after it, while the block is still in cache. Instances
+ * are immutable and can be shared between threads.
+ */
+class CHcaBlockRecipher final {
+
+public:
+    /**
+     * @param cipherFrom Cipher the blocks are enciphered with.
+     * @param cipherTo Cipher to encipher the blocks with.
+     */
+    CHcaBlockRecipher(const CHcaCipher &cipherFrom, const CHcaCipher &cipherTo);
+
+    /**
+     * Checks the checksum and the magic of a block without changing it.
+     * @param block The block, blockSize bytes ending with its checksum.
+     * @param blockSize Size of the block.
+     * @return Whether Convert() would succeed on the block.
+     */
+    [[nodiscard]] auto Verify(const std::uint8_t *block, std::uint32_t blockSize) const -> bool_t;
+
+    /**
+     * Re-enciphers a block and rewrites its checksum.
+     * @param block The block, blockSize bytes ending with its checksum.
+     * @param blockSize Size of the block.
+     * @return FALSE if the checksum or the magic of the block is wrong, in which case the block is
+     * left untouched.
+     */
+    auto Convert(std::uint8_t *block, std::uint32_t blockSize) const -> bool_t;
+
+private:
+    std::array<std::uint8_t, CHcaCipher::TableSize> _decryptTable;
+    // Decryption with the source cipher followed by encryption with the target cipher.
+    std::array<std::uint8_t, CHcaCipher::TableSize> _recipherTable;
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CHCABLOCKRECIPHER_H_
@@ -7,18 +7,58 @@
 
 #include "acb_env_ns.h"
 
+#include "./CCpuFeatures.h"
 #include "./CHcaChannel.h"
 #include "./CHcaData.h"
 
+#ifdef ACB_ARCH_X86
+#include <immintrin.h>
+#endif
+
 ACB_NS_BEGIN
 
+// Implementations of the element-wise loops of the decoding stages, selected once for the running
+// CPU. See GetChannelKernels() at the end of this file.
+struct ChannelKernels {
+    // dst[t] = scales[t] * src[-1 - t], for t in [0, count).
+    void (*scaleMirrored)(float *dst, const float *scales, const float *src, std::uint32_t count);
+    // d[i] = s[i] * f2, then s[i] = s[i] * f1, for i in [0, count).
+    void (*splitIntensity)(float *s, float *d, float f1, float f2, std::uint32_t count);
+    // Inverse transforms of 0x80 and of the lower 0x40 coefficients, writing to wave.
+    void (*decode5)(CHcaChannel *inst, float *wave);
+    void (*decode5Half)(CHcaChannel *inst, float *wave);
+    // Decode5 of up to LaneCount consecutive channels at once, or nullptr if unavailable.
+    void (*decode5Lanes)(CHcaChannel *const *channels, std::uint32_t count, std::int32_t index);
+};
+
+static auto GetChannelKernels() -> const ChannelKernels &;
+
+// Channels transformed together by ChannelKernels::decode5Lanes, and the fewest worth grouping.
+static constexpr std::uint32_t LaneCount        = 8;
+static constexpr std::uint32_t MinLaneGroupSize = 6;
+
 CHcaChannel::CHcaChannel() {
+    Clear();
+}
+
+void CHcaChannel::Clear() {
     std::memset(this, 0, sizeof(CHcaChannel));
 }
 
-void CHcaChannel::Decode1(
+// The channel type fixed at compile time, or the one of inst.
+template<std::int32_t Type>
+static inline auto GetType(const CHcaChannel *inst) -> std::int32_t {
+    if constexpr (Type == CHcaChannel::AnyType) {
+        return inst->type;
+    } else {
+        return Type;
+    }
+}
+
+template<std::int32_t Type>
+auto CHcaChannel::Decode1(
     CHcaChannel *inst, CHcaData *data, std::uint32_t a, int b, const std::uint8_t *ath
-) {
+) -> bool_t {
     // clang-format off
     static constexpr std::array<std::uint8_t, 64> scalelist = {
         // v2.0
@@ -72,6 +112,9 @@ void CHcaChannel::Decode1(
             v4 = data->GetBit(v);
             if (v4 != v2) {
                 v1 += v4 - v3;
+                if (v1 < 0 || v1 >= 0x40) {
+                    return FALSE;
+                }
             } else {
                 v1 = data->GetBit(6);
             }
@@ -80,7 +123,7 @@ void CHcaChannel::Decode1(
     } else {
         inst->value.fill(0);
     }
-    if (inst->type == 2) {
+    if (GetType<Type>(inst) == 2) {
         v               = data->CheckBit(4);
         inst->value2[0] = static_cast<std::int8_t>(v);
         if (v < 15) {
@@ -111,6 +154,7 @@ void CHcaChannel::Decode1(
     for (std::uint32_t i = 0; i < inst->count; i++) {
         inst->base[i] = valueFloat[inst->value[i]] * scaleFloat[inst->scale[i]];
     }
+    return TRUE;
 }
 
 void CHcaChannel::Decode2(CHcaChannel *inst, CHcaData *data) {
@@ -163,10 +207,11 @@ void CHcaChannel::Decode2(CHcaChannel *inst, CHcaData *data) {
     std::fill(inst->block.begin() + inst->count, inst->block.end(), float{0.0f});
 }
 
+template<std::int32_t Type>
 void CHcaChannel::Decode3(
     CHcaChannel *inst, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d
 ) {
-    if (inst->type != 2 && b) {
+    if (GetType<Type>(inst) != 2 && b) {
         // clang-format off
         static constexpr std::array<std::array<std::uint32_t, 0x40>, 2> listInt = {{
             {
@@ -193,15 +238,30 @@ void CHcaChannel::Decode3(
         // clang-format on
 
         static auto *listFloat = reinterpret_cast<const float *>(listInt[1].data());
-        for (std::uint32_t i = 0, k = c, l = c - 1; i < a; i++) {
-            for (std::uint32_t j = 0; j < b && k < d; j++, l--) {
-                inst->block[k++] = listFloat[inst->value3[i] - inst->value[l]] * inst->block[l];
+        // Band i scales b coefficients mirrored from below c, stopping at d.
+        const auto count = c < d ? std::min(a * b, d - c) : 0u;
+        if (count <= c) {
+            // Look up the scales first, then multiply the whole run at once.
+            std::array<float, 0x80> scales;
+            for (std::uint32_t i = 0, t = 0; t < count; i++) {
+                for (std::uint32_t j = 0; j < b && t < count; j++, t++) {
+                    scales[t] = listFloat[inst->value3[i] - inst->value[c - 1 - t]];
+                }
+            }
+            auto highBands = inst->block.data() + c;
+            GetChannelKernels().scaleMirrored(highBands, scales.data(), highBands, count);
+        } else {
+            for (std::uint32_t i = 0, k = c, l = c - 1; i < a; i++) {
+                for (std::uint32_t j = 0; j < b && k < d; j++, l--) {
+                    inst->block[k++] = listFloat[inst->value3[i] - inst->value[l]] * inst->block[l];
+                }
             }
         }
         inst->block.back() = 0;
     }
 }
 
+template<std::int32_t Type>
 void CHcaChannel::Decode4(
     CHcaChannel *inst1,
     CHcaChannel *inst2,
@@ -210,7 +270,7 @@ void CHcaChannel::Decode4(
     std::uint32_t b,
     std::uint32_t c
 ) {
-    if (inst1->type == 1 && c) {
+    if (GetType<Type>(inst1) == 1 && c) {
         // clang-format off
         static constexpr std::array<std::uint32_t, 80> listInt = {
             // v2.0
@@ -232,191 +292,338 @@ void CHcaChannel::Decode4(
         // clang-format on
         float f1 = reinterpret_cast<const float *>(listInt.data())[inst2->value2[index]];
         float f2 = 2.0f - f1;
-        float *s = &inst1->block[b];
-        float *d = &inst2->block[b];
-        for (std::uint32_t i = 0; i < a; i++) {
-            *(d++) = *s * f2;
-            *s     = *s * f1;
-            ++s;
-        }
+        GetChannelKernels().splitIntensity(
+            inst1->block.data() + b, inst2->block.data() + b, f1, f2, a
+        );
     }
 }
 
-void CHcaChannel::Decode5(CHcaChannel *inst, std::int32_t index) {
-    // clang-format off
-    static constexpr std::array<std::array<std::uint32_t, 0x40>, 7> list1Int = {{
-        {
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-            0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
-        },
-        {
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-            0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
-        },
-        {
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-            0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
-        },
-        {
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-            0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
-        },
-        {
-            0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
-            0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
-            0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
-            0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
-            0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
-            0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
-            0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
-            0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
-        },
-        {
-            0x3F7FFB11, 0x3F7FD397, 0x3F7F84AB, 0x3F7F0E58, 0x3F7E70B0, 0x3F7DABCC, 0x3F7CBFC9, 0x3F7BACCD,
-            0x3F7A7302, 0x3F791298, 0x3F778BC5, 0x3F75DEC6, 0x3F740BDD, 0x3F721352, 0x3F6FF573, 0x3F6DB293,
-            0x3F6B4B0C, 0x3F68BF3C, 0x3F660F88, 0x3F633C5A, 0x3F604621, 0x3F5D2D53, 0x3F59F26A, 0x3F5695E5,
-            0x3F531849, 0x3F4F7A1F, 0x3F4BBBF8, 0x3F47DE65, 0x3F43E200, 0x3F3FC767, 0x3F3B8F3B, 0x3F373A23,
-            0x3F7FFB11, 0x3F7FD397, 0x3F7F84AB, 0x3F7F0E58, 0x3F7E70B0, 0x3F7DABCC, 0x3F7CBFC9, 0x3F7BACCD,
-            0x3F7A7302, 0x3F791298, 0x3F778BC5, 0x3F75DEC6, 0x3F740BDD, 0x3F721352, 0x3F6FF573, 0x3F6DB293,
-            0x3F6B4B0C, 0x3F68BF3C, 0x3F660F88, 0x3F633C5A, 0x3F604621, 0x3F5D2D53, 0x3F59F26A, 0x3F5695E5,
-            0x3F531849, 0x3F4F7A1F, 0x3F4BBBF8, 0x3F47DE65, 0x3F43E200, 0x3F3FC767, 0x3F3B8F3B, 0x3F373A23,
-        },
-        {
-            0x3F7FFEC4, 0x3F7FF4E6, 0x3F7FE129, 0x3F7FC38F, 0x3F7F9C18, 0x3F7F6AC7, 0x3F7F2F9D, 0x3F7EEA9D,
-            0x3F7E9BC9, 0x3F7E4323, 0x3F7DE0B1, 0x3F7D7474, 0x3F7CFE73, 0x3F7C7EB0, 0x3F7BF531, 0x3F7B61FC,
-            0x3F7AC516, 0x3F7A1E84, 0x3F796E4E, 0x3F78B47B, 0x3F77F110, 0x3F772417, 0x3F764D97, 0x3F756D97,
-            0x3F748422, 0x3F73913F, 0x3F7294F8, 0x3F718F57, 0x3F708066, 0x3F6F6830, 0x3F6E46BE, 0x3F6D1C1D,
-            0x3F6BE858, 0x3F6AAB7B, 0x3F696591, 0x3F6816A8, 0x3F66BECC, 0x3F655E0B, 0x3F63F473, 0x3F628210,
-            0x3F6106F2, 0x3F5F8327, 0x3F5DF6BE, 0x3F5C61C7, 0x3F5AC450, 0x3F591E6A, 0x3F577026, 0x3F55B993,
-            0x3F53FAC3, 0x3F5233C6, 0x3F5064AF, 0x3F4E8D90, 0x3F4CAE79, 0x3F4AC77F, 0x3F48D8B3, 0x3F46E22A,
-            0x3F44E3F5, 0x3F42DE29, 0x3F40D0DA, 0x3F3EBC1B, 0x3F3CA003, 0x3F3A7CA4, 0x3F385216, 0x3F36206C,
-        },
-    }};
-
-    static constexpr std::array<std::array<std::uint32_t, 0x40>, 7> list2Int = {{
-        {
-            0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
-            0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
-            0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
-            0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
-            0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
-            0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
-            0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
-            0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
-        },
-        {
-            0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
-            0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
-            0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
-            0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
-            0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
-            0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
-            0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
-            0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
-        },
-        {
-            0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
-            0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
-            0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
-            0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
-            0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
-            0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
-            0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
-            0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
-        },
-        {
-            0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
-            0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
-            0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
-            0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
-            0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
-            0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
-            0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
-            0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
-        },
-        {
-            0xBCC90AB0, 0xBD96A905, 0xBDFAB273, 0xBE2F10A2, 0xBE605C13, 0xBE888E93, 0xBEA09AE5, 0xBEB8442A,
-            0xBECF7BCA, 0xBEE63375, 0xBEFC5D27, 0xBF08F59B, 0xBF13682A, 0xBF1D7FD1, 0xBF273656, 0xBF3085BB,
-            0x3CC90AB0, 0x3D96A905, 0x3DFAB273, 0x3E2F10A2, 0x3E605C13, 0x3E888E93, 0x3EA09AE5, 0x3EB8442A,
-            0x3ECF7BCA, 0x3EE63375, 0x3EFC5D27, 0x3F08F59B, 0x3F13682A, 0x3F1D7FD1, 0x3F273656, 0x3F3085BB,
-            0x3CC90AB0, 0x3D96A905, 0x3DFAB273, 0x3E2F10A2, 0x3E605C13, 0x3E888E93, 0x3EA09AE5, 0x3EB8442A,
-            0x3ECF7BCA, 0x3EE63375, 0x3EFC5D27, 0x3F08F59B, 0x3F13682A, 0x3F1D7FD1, 0x3F273656, 0x3F3085BB,
-            0xBCC90AB0, 0xBD96A905, 0xBDFAB273, 0xBE2F10A2, 0xBE605C13, 0xBE888E93, 0xBEA09AE5, 0xBEB8442A,
-            0xBECF7BCA, 0xBEE63375, 0xBEFC5D27, 0xBF08F59B, 0xBF13682A, 0xBF1D7FD1, 0xBF273656, 0xBF3085BB,
-        },
-        {
-            0xBC490E90, 0xBD16C32C, 0xBD7B2B74, 0xBDAFB680, 0xBDE1BC2E, 0xBE09CF86, 0xBE22ABB6, 0xBE3B6ECF,
-            0xBE541501, 0xBE6C9A7F, 0xBE827DC0, 0xBE8E9A22, 0xBE9AA086, 0xBEA68F12, 0xBEB263EF, 0xBEBE1D4A,
-            0xBEC9B953, 0xBED53641, 0xBEE0924F, 0xBEEBCBBB, 0xBEF6E0CB, 0xBF00E7E4, 0xBF064B82, 0xBF0B9A6B,
-            0xBF10D3CD, 0xBF15F6D9, 0xBF1B02C6, 0xBF1FF6CB, 0xBF24D225, 0xBF299415, 0xBF2E3BDE, 0xBF32C8C9,
-            0x3C490E90, 0x3D16C32C, 0x3D7B2B74, 0x3DAFB680, 0x3DE1BC2E, 0x3E09CF86, 0x3E22ABB6, 0x3E3B6ECF,
-            0x3E541501, 0x3E6C9A7F, 0x3E827DC0, 0x3E8E9A22, 0x3E9AA086, 0x3EA68F12, 0x3EB263EF, 0x3EBE1D4A,
-            0x3EC9B953, 0x3ED53641, 0x3EE0924F, 0x3EEBCBBB, 0x3EF6E0CB, 0x3F00E7E4, 0x3F064B82, 0x3F0B9A6B,
-            0x3F10D3CD, 0x3F15F6D9, 0x3F1B02C6, 0x3F1FF6CB, 0x3F24D225, 0x3F299415, 0x3F2E3BDE, 0x3F32C8C9,
-        },
-        {
-            0xBBC90F88, 0xBC96C9B6, 0xBCFB49BA, 0xBD2FE007, 0xBD621469, 0xBD8A200A, 0xBDA3308C, 0xBDBC3AC3,
-            0xBDD53DB9, 0xBDEE3876, 0xBE039502, 0xBE1008B7, 0xBE1C76DE, 0xBE28DEFC, 0xBE354098, 0xBE419B37,
-            0xBE4DEE60, 0xBE5A3997, 0xBE667C66, 0xBE72B651, 0xBE7EE6E1, 0xBE8586CE, 0xBE8B9507, 0xBE919DDD,
-            0xBE97A117, 0xBE9D9E78, 0xBEA395C5, 0xBEA986C4, 0xBEAF713A, 0xBEB554EC, 0xBEBB31A0, 0xBEC1071E,
-            0xBEC6D529, 0xBECC9B8B, 0xBED25A09, 0xBED8106B, 0xBEDDBE79, 0xBEE363FA, 0xBEE900B7, 0xBEEE9479,
-            0xBEF41F07, 0xBEF9A02D, 0xBEFF17B2, 0xBF0242B1, 0xBF04F484, 0xBF07A136, 0xBF0A48AD, 0xBF0CEAD0,
-            0xBF0F8784, 0xBF121EB0, 0xBF14B039, 0xBF173C07, 0xBF19C200, 0xBF1C420C, 0xBF1EBC12, 0xBF212FF9,
-            0xBF239DA9, 0xBF26050A, 0xBF286605, 0xBF2AC082, 0xBF2D1469, 0xBF2F61A5, 0xBF31A81D, 0xBF33E7BC,
-        },
-    }};
-
-    static constexpr std::array<std::uint32_t, static_cast<std::size_t>(0x40 * 2)> list3Int = {
-        0x3A3504F0, 0x3B0183B8, 0x3B70C538, 0x3BBB9268, 0x3C04A809, 0x3C308200, 0x3C61284C, 0x3C8B3F17,
-        0x3CA83992, 0x3CC77FBD, 0x3CE91110, 0x3D0677CD, 0x3D198FC4, 0x3D2DD35C, 0x3D434643, 0x3D59ECC1,
-        0x3D71CBA8, 0x3D85741E, 0x3D92A413, 0x3DA078B4, 0x3DAEF522, 0x3DBE1C9E, 0x3DCDF27B, 0x3DDE7A1D,
-        0x3DEFB6ED, 0x3E00D62B, 0x3E0A2EDA, 0x3E13E72A, 0x3E1E00B1, 0x3E287CF2, 0x3E335D55, 0x3E3EA321,
-        0x3E4A4F75, 0x3E56633F, 0x3E62DF37, 0x3E6FC3D1, 0x3E7D1138, 0x3E8563A2, 0x3E8C72B7, 0x3E93B561,
-        0x3E9B2AEF, 0x3EA2D26F, 0x3EAAAAAB, 0x3EB2B222, 0x3EBAE706, 0x3EC34737, 0x3ECBD03D, 0x3ED47F46,
-        0x3EDD5128, 0x3EE6425C, 0x3EEF4EFF, 0x3EF872D7, 0x3F00D4A9, 0x3F0576CA, 0x3F0A1D3B, 0x3F0EC548,
-        0x3F136C25, 0x3F180EF2, 0x3F1CAAC2, 0x3F213CA2, 0x3F25C1A5, 0x3F2A36E7, 0x3F2E9998, 0x3F32E705,
-
-        0xBF371C9E, 0xBF3B37FE, 0xBF3F36F2, 0xBF431780, 0xBF46D7E6, 0xBF4A76A4, 0xBF4DF27C, 0xBF514A6F,
-        0xBF547DC5, 0xBF578C03, 0xBF5A74EE, 0xBF5D3887, 0xBF5FD707, 0xBF6250DA, 0xBF64A699, 0xBF66D908,
-        0xBF68E90E, 0xBF6AD7B1, 0xBF6CA611, 0xBF6E5562, 0xBF6FE6E7, 0xBF715BEF, 0xBF72B5D1, 0xBF73F5E6,
-        0xBF751D89, 0xBF762E13, 0xBF7728D7, 0xBF780F20, 0xBF78E234, 0xBF79A34C, 0xBF7A5397, 0xBF7AF439,
-        0xBF7B8648, 0xBF7C0ACE, 0xBF7C82C8, 0xBF7CEF26, 0xBF7D50CB, 0xBF7DA88E, 0xBF7DF737, 0xBF7E3D86,
-        0xBF7E7C2A, 0xBF7EB3CC, 0xBF7EE507, 0xBF7F106C, 0xBF7F3683, 0xBF7F57CA, 0xBF7F74B6, 0xBF7F8DB6,
-        0xBF7FA32E, 0xBF7FB57B, 0xBF7FC4F6, 0xBF7FD1ED, 0xBF7FDCAD, 0xBF7FE579, 0xBF7FEC90, 0xBF7FF22E,
-        0xBF7FF688, 0xBF7FF9D0, 0xBF7FFC32, 0xBF7FFDDA, 0xBF7FFEED, 0xBF7FFF8F, 0xBF7FFFDF, 0xBF7FFFFC,
-    };
-    // clang-format on
+// Every channel type, and AnyType for the channels whose type is only known at run time.
+#define ACB_INSTANTIATE_CHANNEL_STAGES(type)                                                       \
+    template auto CHcaChannel::Decode1<type>(                                                      \
+        CHcaChannel *, CHcaData *, std::uint32_t, std::int32_t, const std::uint8_t *               \
+    ) -> bool_t;                                                                                   \
+    template void CHcaChannel::Decode3<type>(                                                      \
+        CHcaChannel *, std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t                  \
+    );                                                                                             \
+    template void CHcaChannel::Decode4<type>(                                                      \
+        CHcaChannel *, CHcaChannel *, std::int32_t, std::uint32_t, std::uint32_t, std::uint32_t    \
+    );
+
+ACB_INSTANTIATE_CHANNEL_STAGES(CHcaChannel::AnyType)
+ACB_INSTANTIATE_CHANNEL_STAGES(0)
+ACB_INSTANTIATE_CHANNEL_STAGES(1)
+ACB_INSTANTIATE_CHANNEL_STAGES(2)
+
+#undef ACB_INSTANTIATE_CHANNEL_STAGES
 
+static void ScaleMirroredScalar(
+    float *dst, const float *scales, const float *src, std::uint32_t count
+) {
+    for (std::uint32_t t = 0; t < count; t++) {
+        dst[t] = scales[t] * *(--src);
+    }
+}
+
+static void SplitIntensityScalar(float *s, float *d, float f1, float f2, std::uint32_t count) {
+    for (std::uint32_t i = 0; i < count; i++) {
+        *(d++) = *s * f2;
+        *s     = *s * f1;
+        ++s;
+    }
+}
+
+// Tables of the inverse MDCT done by Decode5.
+// clang-format off
+static constexpr std::array<std::array<std::uint32_t, 0x40>, 7> list1Int = {{
+    {
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+    },
+    {
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+    },
+    {
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+    },
+    {
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+    },
+    {
+        0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
+        0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
+        0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
+        0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
+        0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
+        0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
+        0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
+        0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
+    },
+    {
+        0x3F7FFB11, 0x3F7FD397, 0x3F7F84AB, 0x3F7F0E58, 0x3F7E70B0, 0x3F7DABCC, 0x3F7CBFC9, 0x3F7BACCD,
+        0x3F7A7302, 0x3F791298, 0x3F778BC5, 0x3F75DEC6, 0x3F740BDD, 0x3F721352, 0x3F6FF573, 0x3F6DB293,
+        0x3F6B4B0C, 0x3F68BF3C, 0x3F660F88, 0x3F633C5A, 0x3F604621, 0x3F5D2D53, 0x3F59F26A, 0x3F5695E5,
+        0x3F531849, 0x3F4F7A1F, 0x3F4BBBF8, 0x3F47DE65, 0x3F43E200, 0x3F3FC767, 0x3F3B8F3B, 0x3F373A23,
+        0x3F7FFB11, 0x3F7FD397, 0x3F7F84AB, 0x3F7F0E58, 0x3F7E70B0, 0x3F7DABCC, 0x3F7CBFC9, 0x3F7BACCD,
+        0x3F7A7302, 0x3F791298, 0x3F778BC5, 0x3F75DEC6, 0x3F740BDD, 0x3F721352, 0x3F6FF573, 0x3F6DB293,
+        0x3F6B4B0C, 0x3F68BF3C, 0x3F660F88, 0x3F633C5A, 0x3F604621, 0x3F5D2D53, 0x3F59F26A, 0x3F5695E5,
+        0x3F531849, 0x3F4F7A1F, 0x3F4BBBF8, 0x3F47DE65, 0x3F43E200, 0x3F3FC767, 0x3F3B8F3B, 0x3F373A23,
+    },
+    {
+        0x3F7FFEC4, 0x3F7FF4E6, 0x3F7FE129, 0x3F7FC38F, 0x3F7F9C18, 0x3F7F6AC7, 0x3F7F2F9D, 0x3F7EEA9D,
+        0x3F7E9BC9, 0x3F7E4323, 0x3F7DE0B1, 0x3F7D7474, 0x3F7CFE73, 0x3F7C7EB0, 0x3F7BF531, 0x3F7B61FC,
+        0x3F7AC516, 0x3F7A1E84, 0x3F796E4E, 0x3F78B47B, 0x3F77F110, 0x3F772417, 0x3F764D97, 0x3F756D97,
+        0x3F748422, 0x3F73913F, 0x3F7294F8, 0x3F718F57, 0x3F708066, 0x3F6F6830, 0x3F6E46BE, 0x3F6D1C1D,
+        0x3F6BE858, 0x3F6AAB7B, 0x3F696591, 0x3F6816A8, 0x3F66BECC, 0x3F655E0B, 0x3F63F473, 0x3F628210,
+        0x3F6106F2, 0x3F5F8327, 0x3F5DF6BE, 0x3F5C61C7, 0x3F5AC450, 0x3F591E6A, 0x3F577026, 0x3F55B993,
+        0x3F53FAC3, 0x3F5233C6, 0x3F5064AF, 0x3F4E8D90, 0x3F4CAE79, 0x3F4AC77F, 0x3F48D8B3, 0x3F46E22A,
+        0x3F44E3F5, 0x3F42DE29, 0x3F40D0DA, 0x3F3EBC1B, 0x3F3CA003, 0x3F3A7CA4, 0x3F385216, 0x3F36206C,
+    },
+}};
+
+static constexpr std::array<std::array<std::uint32_t, 0x40>, 7> list2Int = {{
+    {
+        0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
+        0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
+        0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
+        0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
+        0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
+        0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
+        0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
+        0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
+    },
+    {
+        0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
+        0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
+        0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
+        0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
+        0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
+        0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
+        0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
+        0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
+    },
+    {
+        0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
+        0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
+        0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
+        0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
+        0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
+        0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
+        0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
+        0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
+    },
+    {
+        0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
+        0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
+        0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
+        0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
+        0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
+        0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
+        0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
+        0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
+    },
+    {
+        0xBCC90AB0, 0xBD96A905, 0xBDFAB273, 0xBE2F10A2, 0xBE605C13, 0xBE888E93, 0xBEA09AE5, 0xBEB8442A,
+        0xBECF7BCA, 0xBEE63375, 0xBEFC5D27, 0xBF08F59B, 0xBF13682A, 0xBF1D7FD1, 0xBF273656, 0xBF3085BB,
+        0x3CC90AB0, 0x3D96A905, 0x3DFAB273, 0x3E2F10A2, 0x3E605C13, 0x3E888E93, 0x3EA09AE5, 0x3EB8442A,
+        0x3ECF7BCA, 0x3EE63375, 0x3EFC5D27, 0x3F08F59B, 0x3F13682A, 0x3F1D7FD1, 0x3F273656, 0x3F3085BB,
+        0x3CC90AB0, 0x3D96A905, 0x3DFAB273, 0x3E2F10A2, 0x3E605C13, 0x3E888E93, 0x3EA09AE5, 0x3EB8442A,
+        0x3ECF7BCA, 0x3EE63375, 0x3EFC5D27, 0x3F08F59B, 0x3F13682A, 0x3F1D7FD1, 0x3F273656, 0x3F3085BB,
+        0xBCC90AB0, 0xBD96A905, 0xBDFAB273, 0xBE2F10A2, 0xBE605C13, 0xBE888E93, 0xBEA09AE5, 0xBEB8442A,
+        0xBECF7BCA, 0xBEE63375, 0xBEFC5D27, 0xBF08F59B, 0xBF13682A, 0xBF1D7FD1, 0xBF273656, 0xBF3085BB,
+    },
+    {
+        0xBC490E90, 0xBD16C32C, 0xBD7B2B74, 0xBDAFB680, 0xBDE1BC2E, 0xBE09CF86, 0xBE22ABB6, 0xBE3B6ECF,
+        0xBE541501, 0xBE6C9A7F, 0xBE827DC0, 0xBE8E9A22, 0xBE9AA086, 0xBEA68F12, 0xBEB263EF, 0xBEBE1D4A,
+        0xBEC9B953, 0xBED53641, 0xBEE0924F, 0xBEEBCBBB, 0xBEF6E0CB, 0xBF00E7E4, 0xBF064B82, 0xBF0B9A6B,
+        0xBF10D3CD, 0xBF15F6D9, 0xBF1B02C6, 0xBF1FF6CB, 0xBF24D225, 0xBF299415, 0xBF2E3BDE, 0xBF32C8C9,
+        0x3C490E90, 0x3D16C32C, 0x3D7B2B74, 0x3DAFB680, 0x3DE1BC2E, 0x3E09CF86, 0x3E22ABB6, 0x3E3B6ECF,
+        0x3E541501, 0x3E6C9A7F, 0x3E827DC0, 0x3E8E9A22, 0x3E9AA086, 0x3EA68F12, 0x3EB263EF, 0x3EBE1D4A,
+        0x3EC9B953, 0x3ED53641, 0x3EE0924F, 0x3EEBCBBB, 0x3EF6E0CB, 0x3F00E7E4, 0x3F064B82, 0x3F0B9A6B,
+        0x3F10D3CD, 0x3F15F6D9, 0x3F1B02C6, 0x3F1FF6CB, 0x3F24D225, 0x3F299415, 0x3F2E3BDE, 0x3F32C8C9,
+    },
+    {
+        0xBBC90F88, 0xBC96C9B6, 0xBCFB49BA, 0xBD2FE007, 0xBD621469, 0xBD8A200A, 0xBDA3308C, 0xBDBC3AC3,
+        0xBDD53DB9, 0xBDEE3876, 0xBE039502, 0xBE1008B7, 0xBE1C76DE, 0xBE28DEFC, 0xBE354098, 0xBE419B37,
+        0xBE4DEE60, 0xBE5A3997, 0xBE667C66, 0xBE72B651, 0xBE7EE6E1, 0xBE8586CE, 0xBE8B9507, 0xBE919DDD,
+        0xBE97A117, 0xBE9D9E78, 0xBEA395C5, 0xBEA986C4, 0xBEAF713A, 0xBEB554EC, 0xBEBB31A0, 0xBEC1071E,
+        0xBEC6D529, 0xBECC9B8B, 0xBED25A09, 0xBED8106B, 0xBEDDBE79, 0xBEE363FA, 0xBEE900B7, 0xBEEE9479,
+        0xBEF41F07, 0xBEF9A02D, 0xBEFF17B2, 0xBF0242B1, 0xBF04F484, 0xBF07A136, 0xBF0A48AD, 0xBF0CEAD0,
+        0xBF0F8784, 0xBF121EB0, 0xBF14B039, 0xBF173C07, 0xBF19C200, 0xBF1C420C, 0xBF1EBC12, 0xBF212FF9,
+        0xBF239DA9, 0xBF26050A, 0xBF286605, 0xBF2AC082, 0xBF2D1469, 0xBF2F61A5, 0xBF31A81D, 0xBF33E7BC,
+    },
+}};
+
+static constexpr std::array<std::uint32_t, static_cast<std::size_t>(0x40 * 2)> list3Int = {
+    0x3A3504F0, 0x3B0183B8, 0x3B70C538, 0x3BBB9268, 0x3C04A809, 0x3C308200, 0x3C61284C, 0x3C8B3F17,
+    0x3CA83992, 0x3CC77FBD, 0x3CE91110, 0x3D0677CD, 0x3D198FC4, 0x3D2DD35C, 0x3D434643, 0x3D59ECC1,
+    0x3D71CBA8, 0x3D85741E, 0x3D92A413, 0x3DA078B4, 0x3DAEF522, 0x3DBE1C9E, 0x3DCDF27B, 0x3DDE7A1D,
+    0x3DEFB6ED, 0x3E00D62B, 0x3E0A2EDA, 0x3E13E72A, 0x3E1E00B1, 0x3E287CF2, 0x3E335D55, 0x3E3EA321,
+    0x3E4A4F75, 0x3E56633F, 0x3E62DF37, 0x3E6FC3D1, 0x3E7D1138, 0x3E8563A2, 0x3E8C72B7, 0x3E93B561,
+    0x3E9B2AEF, 0x3EA2D26F, 0x3EAAAAAB, 0x3EB2B222, 0x3EBAE706, 0x3EC34737, 0x3ECBD03D, 0x3ED47F46,
+    0x3EDD5128, 0x3EE6425C, 0x3EEF4EFF, 0x3EF872D7, 0x3F00D4A9, 0x3F0576CA, 0x3F0A1D3B, 0x3F0EC548,
+    0x3F136C25, 0x3F180EF2, 0x3F1CAAC2, 0x3F213CA2, 0x3F25C1A5, 0x3F2A36E7, 0x3F2E9998, 0x3F32E705,
+
+    0xBF371C9E, 0xBF3B37FE, 0xBF3F36F2, 0xBF431780, 0xBF46D7E6, 0xBF4A76A4, 0xBF4DF27C, 0xBF514A6F,
+    0xBF547DC5, 0xBF578C03, 0xBF5A74EE, 0xBF5D3887, 0xBF5FD707, 0xBF6250DA, 0xBF64A699, 0xBF66D908,
+    0xBF68E90E, 0xBF6AD7B1, 0xBF6CA611, 0xBF6E5562, 0xBF6FE6E7, 0xBF715BEF, 0xBF72B5D1, 0xBF73F5E6,
+    0xBF751D89, 0xBF762E13, 0xBF7728D7, 0xBF780F20, 0xBF78E234, 0xBF79A34C, 0xBF7A5397, 0xBF7AF439,
+    0xBF7B8648, 0xBF7C0ACE, 0xBF7C82C8, 0xBF7CEF26, 0xBF7D50CB, 0xBF7DA88E, 0xBF7DF737, 0xBF7E3D86,
+    0xBF7E7C2A, 0xBF7EB3CC, 0xBF7EE507, 0xBF7F106C, 0xBF7F3683, 0xBF7F57CA, 0xBF7F74B6, 0xBF7F8DB6,
+    0xBF7FA32E, 0xBF7FB57B, 0xBF7FC4F6, 0xBF7FD1ED, 0xBF7FDCAD, 0xBF7FE579, 0xBF7FEC90, 0xBF7FF22E,
+    0xBF7FF688, 0xBF7FF9D0, 0xBF7FFC32, 0xBF7FFDDA, 0xBF7FFEED, 0xBF7FFF8F, 0xBF7FFFDF, 0xBF7FFFFC,
+};
+
+// Tables of the half-size inverse MDCT done by Decode5Half. They follow the factorization of the
+// tables above with one stage less: stage i rotates by (2k + 1) * pi / (8 << i), clockwise when
+// j has an even number of bits set, and stage 0 carries the 1 / (8 * sqrt(2)) scale. The window is
+// list3Int resampled to half the length, renormalized so that overlapping halves still add up.
+static constexpr std::array<std::array<std::uint32_t, 0x20>, 6> list1HalfInt = {{
+    {
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+        0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75, 0x3DA73D75,
+    },
+    {
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+        0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31, 0x3F7B14BE, 0x3F54DB31,
+    },
+    {
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+        0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403, 0x3F7EC46D, 0x3F74FA0B, 0x3F61C598, 0x3F45E403,
+    },
+    {
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+        0x3F7FB10F, 0x3F7D3AAC, 0x3F7853F8, 0x3F710908, 0x3F676BD8, 0x3F5B941A, 0x3F4D9F02, 0x3F3DAEF9,
+    },
+    {
+        0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
+        0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
+        0x3F7FEC43, 0x3F7F4E6D, 0x3F7E1324, 0x3F7C3B28, 0x3F79C79D, 0x3F76BA07, 0x3F731447, 0x3F6ED89E,
+        0x3F6A09A7, 0x3F64AA59, 0x3F5EBE05, 0x3F584853, 0x3F514D3D, 0x3F49D112, 0x3F41D870, 0x3F396842,
+    },
+    {
+        0x3F7FFB11, 0x3F7FD397, 0x3F7F84AB, 0x3F7F0E58, 0x3F7E70B0, 0x3F7DABCC, 0x3F7CBFC9, 0x3F7BACCD,
+        0x3F7A7302, 0x3F791298, 0x3F778BC5, 0x3F75DEC6, 0x3F740BDD, 0x3F721352, 0x3F6FF573, 0x3F6DB293,
+        0x3F6B4B0C, 0x3F68BF3C, 0x3F660F88, 0x3F633C5A, 0x3F604621, 0x3F5D2D53, 0x3F59F26A, 0x3F5695E5,
+        0x3F531849, 0x3F4F7A1F, 0x3F4BBBF8, 0x3F47DE65, 0x3F43E200, 0x3F3FC767, 0x3F3B8F3B, 0x3F373A23,
+    },
+}};
+
+static constexpr std::array<std::array<std::uint32_t, 0x20>, 6> list2HalfInt = {{
+    {
+        0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
+        0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
+        0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4,
+        0xBD0A8BD4, 0x3D0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4, 0xBD0A8BD4, 0xBD0A8BD4, 0x3D0A8BD4,
+    },
+    {
+        0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
+        0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
+        0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA,
+        0xBE47C5C2, 0xBF0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0x3E47C5C2, 0x3F0E39DA, 0xBE47C5C2, 0xBF0E39DA,
+    },
+    {
+        0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
+        0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
+        0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799, 0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799,
+        0xBDC8BD36, 0xBE94A031, 0xBEF15AEA, 0xBF226799, 0x3DC8BD36, 0x3E94A031, 0x3EF15AEA, 0x3F226799,
+    },
+    {
+        0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
+        0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
+        0x3D48FB30, 0x3E164083, 0x3E78CFCC, 0x3EAC7CD4, 0x3EDAE880, 0x3F039C3D, 0x3F187FC0, 0x3F2BEB4A,
+        0xBD48FB30, 0xBE164083, 0xBE78CFCC, 0xBEAC7CD4, 0xBEDAE880, 0xBF039C3D, 0xBF187FC0, 0xBF2BEB4A,
+    },
+    {
+        0xBCC90AB0, 0xBD96A905, 0xBDFAB273, 0xBE2F10A2, 0xBE605C13, 0xBE888E93, 0xBEA09AE5, 0xBEB8442A,
+        0xBECF7BCA, 0xBEE63375, 0xBEFC5D27, 0xBF08F59B, 0xBF13682A, 0xBF1D7FD1, 0xBF273656, 0xBF3085BB,
+        0x3CC90AB0, 0x3D96A905, 0x3DFAB273, 0x3E2F10A2, 0x3E605C13, 0x3E888E93, 0x3EA09AE5, 0x3EB8442A,
+        0x3ECF7BCA, 0x3EE63375, 0x3EFC5D27, 0x3F08F59B, 0x3F13682A, 0x3F1D7FD1, 0x3F273656, 0x3F3085BB,
+    },
+    {
+        0xBC490E90, 0xBD16C32C, 0xBD7B2B74, 0xBDAFB680, 0xBDE1BC2E, 0xBE09CF86, 0xBE22ABB6, 0xBE3B6ECF,
+        0xBE541501, 0xBE6C9A7F, 0xBE827DC0, 0xBE8E9A22, 0xBE9AA086, 0xBEA68F12, 0xBEB263EF, 0xBEBE1D4A,
+        0xBEC9B953, 0xBED53641, 0xBEE0924F, 0xBEEBCBBB, 0xBEF6E0CB, 0xBF00E7E4, 0xBF064B82, 0xBF0B9A6B,
+        0xBF10D3CD, 0xBF15F6D9, 0xBF1B02C6, 0xBF1FF6CB, 0xBF24D225, 0xBF299415, 0xBF2E3BDE, 0xBF32C8C9,
+    },
+}};
+
+static constexpr std::array<std::uint32_t, static_cast<std::size_t>(0x20 * 2)> list3HalfInt = {
+    0x3AAEC4F6, 0x3B99FA87, 0x3C1A950E, 0x3C7BD353, 0x3CB7DCBE, 0x3CFB007C, 0x3D23B1B1, 0x3D4E99B6,
+    0x3D7E5A41, 0x3D998E9D, 0x3DB68932, 0x3DD636C0, 0x3DF8B240, 0x3E0F0B6E, 0x3E233F61, 0x3E3900F9,
+    0x3E505A52, 0x3E6952C4, 0x3E81F6EB, 0x3E90150E, 0x3E9EFFF1, 0x3EAEAFF5, 0x3EBF1905, 0x3ED02A0D,
+    0x3EE1CC7E, 0x3EF3E423, 0x3F032797, 0x3F0C7362, 0x3F15BFEF, 0x3F1EF655, 0x3F27FF23, 0x3F30C35C,
+    0xBF392D81, 0xBF412A84, 0xBF48AA9A, 0xBF4FA1C6, 0xBF560822, 0xBF5BD9DB, 0xBF6116E9, 0xBF65C299,
+    0xBF69E2F4, 0xBF6D8017, 0xBF70A390, 0xBF7357C8, 0xBF75A786, 0xBF779D80, 0xBF794415, 0xBF7AA512,
+    0xBF7BC98D, 0xBF7CB9D6, 0xBF7D7D6B, 0xBF7E1B01, 0xBF7E9884, 0xBF7EFB2C, 0xBF7F4786, 0xBF7F8185,
+    0xBF7FAC95, 0xBF7FCBA5, 0xBF7FE13B, 0xBF7FEF7E, 0xBF7FF842, 0xBF7FFD15, 0xBF7FFF47, 0xBF7FFFF1,
+};
+// clang-format on
+
+// The tables of the inverse MDCT of Size coefficients.
+template<std::int32_t Size>
+struct TransformTables;
+
+template<>
+struct TransformTables<0x80> {
+    static constexpr const auto &list1 = list1Int;
+    static constexpr const auto &list2 = list2Int;
+    static constexpr const auto &list3 = list3Int;
+};
+
+template<>
+struct TransformTables<0x40> {
+    static constexpr const auto &list1 = list1HalfInt;
+    static constexpr const auto &list2 = list2HalfInt;
+    static constexpr const auto &list3 = list3HalfInt;
+};
+
+// Decode5 for the first Size coefficients of block. Writes Size samples to wave, and keeps the
+// overlap in the first Size entries of wav3.
+template<std::int32_t Size>
+static void Decode5Scalar(CHcaChannel *inst, float *wave) {
+    using Tables = TransformTables<Size>;
     {
         auto s = inst->block.begin();
         auto d = inst->wav1.begin();
         for (auto [i, count1, count2] =
-                 std::tuple{std::size_t{0}, std::int32_t{1}, std::int32_t{0x40}};
-             i < list1Int.size();
+                 std::tuple{std::size_t{0}, std::int32_t{1}, std::int32_t{Size / 2}};
+             i < Tables::list1.size();
              i++, count1 <<= 1, count2 >>= 1) {
             auto d1 = d;
             auto d2 = d + count2;
@@ -430,7 +637,7 @@ void CHcaChannel::Decode5(CHcaChannel *inst, std::int32_t index) {
                 d1 += count2;
                 d2 += count2;
             }
-            auto w = s - inst->block.size();
+            auto w = s - Size;
             s      = d;
             d      = w;
         }
@@ -440,11 +647,11 @@ void CHcaChannel::Decode5(CHcaChannel *inst, std::int32_t index) {
         auto s = inst->wav1.begin();
         auto d = inst->block.begin();
         for (auto [i, count1, count2] =
-                 std::tuple{std::size_t{0}, std::int32_t{0x40}, std::int32_t{1}};
-             i < list1Int.size();
+                 std::tuple{std::size_t{0}, std::int32_t{Size / 2}, std::int32_t{1}};
+             i < Tables::list1.size();
              i++, count1 >>= 1, count2 <<= 1) {
-            auto *list1Float = reinterpret_cast<const float *>(list1Int[i].data());
-            auto *list2Float = reinterpret_cast<const float *>(list2Int[i].data());
+            auto *list1Float = reinterpret_cast<const float *>(Tables::list1[i].data());
+            auto *list2Float = reinterpret_cast<const float *>(Tables::list2[i].data());
             auto sa1         = s;
             auto sa2         = sa1 + count2;
             auto d1          = d;
@@ -466,32 +673,563 @@ void CHcaChannel::Decode5(CHcaChannel *inst, std::int32_t index) {
             std::swap(s, d);
         }
         d = inst->wav2.begin();
-        for (std::int32_t i = 0; i < 0x80; i++) {
+        for (std::int32_t i = 0; i < Size; i++) {
             *(d++) = *(s++);
         }
     }
 
     {
-        const auto *s = reinterpret_cast<const float *>(list3Int.data());
-        auto d        = inst->wave[index].begin();
-        auto s1       = inst->wav2.begin() + inst->wav2.size() / 2;
+        const auto *s = reinterpret_cast<const float *>(Tables::list3.data());
+        auto d        = wave;
+        auto s1       = inst->wav2.begin() + Size / 2;
         auto s2       = inst->wav3.begin();
 
-        for (std::size_t i = 0; i < list3Int.size() / 2; ++i) {
+        for (std::size_t i = 0; i < Tables::list3.size() / 2; ++i) {
             *(d++) = *(s1++) * *(s++) + *(s2++);
         }
-        for (std::size_t i = 0; i < list3Int.size() / 2; ++i) {
+        for (std::size_t i = 0; i < Tables::list3.size() / 2; ++i) {
             *(d++) = *(s++) * *(--s1) - *(s2++);
         }
-        s1 = inst->wav2.begin() + inst->wav2.size() / 2 - 1;
+        s1 = inst->wav2.begin() + Size / 2 - 1;
         s2 = inst->wav3.begin();
-        for (std::size_t i = 0; i < list3Int.size() / 2; ++i) {
+        for (std::size_t i = 0; i < Tables::list3.size() / 2; ++i) {
             *(s2++) = *(s1--) * *(--s);
         }
-        for (std::size_t i = 0; i < list3Int.size() / 2; ++i) {
+        for (std::size_t i = 0; i < Tables::list3.size() / 2; ++i) {
             *(s2++) = *(--s) * *(++s1);
         }
     }
 }
 
+#ifdef ACB_ARCH_X86
+
+// The vector versions of Decode5 evaluate every output with the same operations as Decode5Scalar,
+// so the results are bit-identical. Passes alternate between block and wav1 like the scalar code,
+// except that the last one writes to wav2 directly instead of copying.
+//
+// Butterfly pass: for m = j * count2 + k, d[j * count2 * 2 + k] = s[m * 2 + 1] + s[m * 2] and
+// d[j * count2 * 2 + count2 + k] = s[m * 2] - s[m * 2 + 1].
+// Rotation pass: for m = j * count2 + k, with fa = s[j * count2 * 2 + k] and
+// fb = s[j * count2 * 2 + count2 + k], d[j * count2 * 2 + k] = fa * c[m] - fb * s[m] and
+// d[j * count2 * 2 + count2 * 2 - 1 - k] = fa * s[m] + fb * c[m].
+
+// SSE2: 4 floats per vector.
+
+ACB_TARGET("sse2")
+static inline auto ReverseSse2(__m128 v) -> __m128 {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+ACB_TARGET("sse2")
+static void ScaleMirroredSse2(
+    float *dst, const float *scales, const float *src, std::uint32_t count
+) {
+    std::uint32_t t = 0;
+    for (; t + 4 <= count; t += 4) {
+        const auto mirrored = ReverseSse2(_mm_loadu_ps(src - 4 - t));
+        _mm_storeu_ps(dst + t, _mm_mul_ps(_mm_loadu_ps(scales + t), mirrored));
+    }
+    ScaleMirroredScalar(dst + t, scales + t, src - t, count - t);
+}
+
+ACB_TARGET("sse2")
+static void SplitIntensitySse2(float *s, float *d, float f1, float f2, std::uint32_t count) {
+    const auto v1 = _mm_set1_ps(f1);
+    const auto v2 = _mm_set1_ps(f2);
+
+    std::uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const auto x = _mm_loadu_ps(s + i);
+        _mm_storeu_ps(d + i, _mm_mul_ps(x, v2));
+        _mm_storeu_ps(s + i, _mm_mul_ps(x, v1));
+    }
+    SplitIntensityScalar(s + i, d + i, f1, f2, count - i);
+}
+
+template<std::int32_t Size>
+ACB_TARGET("sse2")
+static void ButterflyPassSse2(const float *s, float *d, std::int32_t count2) {
+    for (std::int32_t m = 0; m < Size / 2; m += 4, s += 8) {
+        const auto x0   = _mm_loadu_ps(s);
+        const auto x1   = _mm_loadu_ps(s + 4);
+        const auto a    = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+        const auto b    = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+        const auto sum  = _mm_add_ps(b, a);
+        const auto diff = _mm_sub_ps(a, b);
+        if (count2 >= 4) {
+            const auto d1 = d + (m / count2) * count2 * 2 + m % count2;
+            _mm_storeu_ps(d1, sum);
+            _mm_storeu_ps(d1 + count2, diff);
+        } else if (count2 == 2) {
+            const auto pd1 = _mm_castps_pd(sum);
+            const auto pd2 = _mm_castps_pd(diff);
+            _mm_storeu_ps(d + m * 2, _mm_castpd_ps(_mm_unpacklo_pd(pd1, pd2)));
+            _mm_storeu_ps(d + m * 2 + 4, _mm_castpd_ps(_mm_unpackhi_pd(pd1, pd2)));
+        } else {
+            _mm_storeu_ps(d + m * 2, _mm_unpacklo_ps(sum, diff));
+            _mm_storeu_ps(d + m * 2 + 4, _mm_unpackhi_ps(sum, diff));
+        }
+    }
+}
+
+template<std::int32_t Size>
+ACB_TARGET("sse2")
+static void RotationPassSse2(
+    const float *s, float *d, std::int32_t count2, const float *list1, const float *list2
+) {
+    if (count2 >= 4) {
+        for (std::int32_t m = 0; m < Size / 2; s += count2 * 2, d += count2 * 2) {
+            for (std::int32_t k = 0; k < count2; k += 4, m += 4) {
+                const auto fa = _mm_loadu_ps(s + k);
+                const auto fb = _mm_loadu_ps(s + count2 + k);
+                const auto fc = _mm_loadu_ps(list1 + m);
+                const auto fd = _mm_loadu_ps(list2 + m);
+                const auto r1 = _mm_sub_ps(_mm_mul_ps(fa, fc), _mm_mul_ps(fb, fd));
+                const auto r2 = _mm_add_ps(_mm_mul_ps(fa, fd), _mm_mul_ps(fb, fc));
+                _mm_storeu_ps(d + k, r1);
+                _mm_storeu_ps(d + count2 * 2 - 4 - k, ReverseSse2(r2));
+            }
+        }
+        return;
+    }
+
+    for (std::int32_t m = 0; m < Size / 2; m += 4, s += 8, d += 8) {
+        const auto x0 = _mm_loadu_ps(s);
+        const auto x1 = _mm_loadu_ps(s + 4);
+        const auto fc = _mm_loadu_ps(list1 + m);
+        const auto fd = _mm_loadu_ps(list2 + m);
+        if (count2 == 2) {
+            const auto fa = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(1, 0, 1, 0));
+            const auto fb = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 2, 3, 2));
+            const auto r1 = _mm_sub_ps(_mm_mul_ps(fa, fc), _mm_mul_ps(fb, fd));
+            const auto r2 = _mm_add_ps(_mm_mul_ps(fa, fd), _mm_mul_ps(fb, fc));
+            _mm_storeu_ps(d, _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(0, 1, 1, 0)));
+            _mm_storeu_ps(d + 4, _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(2, 3, 3, 2)));
+        } else {
+            const auto fa = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto fb = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+            const auto r1 = _mm_sub_ps(_mm_mul_ps(fa, fc), _mm_mul_ps(fb, fd));
+            const auto r2 = _mm_add_ps(_mm_mul_ps(fa, fd), _mm_mul_ps(fb, fc));
+            _mm_storeu_ps(d, _mm_unpacklo_ps(r1, r2));
+            _mm_storeu_ps(d + 4, _mm_unpackhi_ps(r1, r2));
+        }
+    }
+}
+
+template<std::int32_t Size>
+ACB_TARGET("sse2")
+static void OverlapAddSse2(const float *wav2, float *wav3, float *wave) {
+    constexpr auto half = Size / 2;
+    const auto *list3   = reinterpret_cast<const float *>(TransformTables<Size>::list3.data());
+    for (std::int32_t i = 0; i < half; i += 4) {
+        const auto lo    = _mm_loadu_ps(wav2 + i);
+        const auto hi    = _mm_loadu_ps(wav2 + half + i);
+        const auto revLo = ReverseSse2(_mm_loadu_ps(wav2 + half - 4 - i));
+        const auto revHi = ReverseSse2(_mm_loadu_ps(wav2 + Size - 4 - i));
+        const auto w1    = _mm_mul_ps(hi, _mm_loadu_ps(list3 + i));
+        const auto w2    = _mm_mul_ps(_mm_loadu_ps(list3 + half + i), revHi);
+        _mm_storeu_ps(wave + i, _mm_add_ps(w1, _mm_loadu_ps(wav3 + i)));
+        _mm_storeu_ps(wave + half + i, _mm_sub_ps(w2, _mm_loadu_ps(wav3 + half + i)));
+        _mm_storeu_ps(wav3 + i, _mm_mul_ps(revLo, ReverseSse2(_mm_loadu_ps(list3 + Size - 4 - i))));
+        _mm_storeu_ps(
+            wav3 + half + i, _mm_mul_ps(ReverseSse2(_mm_loadu_ps(list3 + half - 4 - i)), lo)
+        );
+    }
+}
+
+template<std::int32_t Size>
+ACB_TARGET("sse2")
+static void Decode5Sse2(CHcaChannel *inst, float *wave) {
+    using Tables = TransformTables<Size>;
+    auto s       = inst->block.data();
+    auto d       = inst->wav1.data();
+    for (std::int32_t count2 = Size / 2; count2 > 0; count2 >>= 1) {
+        ButterflyPassSse2<Size>(s, d, count2);
+        std::swap(s, d);
+    }
+    for (std::size_t i = 0; i < Tables::list1.size(); ++i) {
+        const auto count2 = std::int32_t{1} << i;
+        const auto d1     = i + 1 < Tables::list1.size() ? d : inst->wav2.data();
+        RotationPassSse2<Size>(
+            s,
+            d1,
+            count2,
+            reinterpret_cast<const float *>(Tables::list1[i].data()),
+            reinterpret_cast<const float *>(Tables::list2[i].data())
+        );
+        std::swap(s, d);
+    }
+    OverlapAddSse2<Size>(inst->wav2.data(), inst->wav3.data(), wave);
+}
+
+// AVX2: 8 floats per vector. Most shuffles work within 128-bit lanes, so the even/odd split of 16
+// consecutive floats yields elements in the order m + {0, 1, 4, 5, 2, 3, 6, 7}. Narrow passes take
+// that order into account instead of restoring it.
+
+ACB_TARGET("avx2")
+static inline auto ReverseAvx2(__m256 v) -> __m256 {
+    const auto r = _mm256_permute_ps(v, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm256_permute2f128_ps(r, r, 0x01);
+}
+
+// Reorders m + {0, 1, 2, 3, 4, 5, 6, 7} to m + {0, 1, 4, 5, 2, 3, 6, 7}, and back.
+ACB_TARGET("avx2")
+static inline auto SwapMiddlePairsAvx2(__m256 v) -> __m256 {
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+ACB_TARGET("avx2")
+static void ScaleMirroredAvx2(
+    float *dst, const float *scales, const float *src, std::uint32_t count
+) {
+    std::uint32_t t = 0;
+    for (; t + 8 <= count; t += 8) {
+        const auto mirrored = ReverseAvx2(_mm256_loadu_ps(src - 8 - t));
+        _mm256_storeu_ps(dst + t, _mm256_mul_ps(_mm256_loadu_ps(scales + t), mirrored));
+    }
+    ScaleMirroredSse2(dst + t, scales + t, src - t, count - t);
+}
+
+ACB_TARGET("avx2")
+static void SplitIntensityAvx2(float *s, float *d, float f1, float f2, std::uint32_t count) {
+    const auto v1 = _mm256_set1_ps(f1);
+    const auto v2 = _mm256_set1_ps(f2);
+
+    std::uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const auto x = _mm256_loadu_ps(s + i);
+        _mm256_storeu_ps(d + i, _mm256_mul_ps(x, v2));
+        _mm256_storeu_ps(s + i, _mm256_mul_ps(x, v1));
+    }
+    SplitIntensitySse2(s + i, d + i, f1, f2, count - i);
+}
+
+template<std::int32_t Size>
+ACB_TARGET("avx2")
+static void ButterflyPassAvx2(const float *s, float *d, std::int32_t count2) {
+    for (std::int32_t m = 0; m < Size / 2; m += 8, s += 16) {
+        const auto x0   = _mm256_loadu_ps(s);
+        const auto x1   = _mm256_loadu_ps(s + 8);
+        const auto a    = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+        const auto b    = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+        const auto sum  = _mm256_add_ps(b, a);
+        const auto diff = _mm256_sub_ps(a, b);
+        if (count2 >= 8) {
+            const auto d1 = d + (m / count2) * count2 * 2 + m % count2;
+            _mm256_storeu_ps(d1, SwapMiddlePairsAvx2(sum));
+            _mm256_storeu_ps(d1 + count2, SwapMiddlePairsAvx2(diff));
+        } else if (count2 == 4) {
+            const auto ps1 = SwapMiddlePairsAvx2(sum);
+            const auto ps2 = SwapMiddlePairsAvx2(diff);
+            _mm256_storeu_ps(d + m * 2, _mm256_permute2f128_ps(ps1, ps2, 0x20));
+            _mm256_storeu_ps(d + m * 2 + 8, _mm256_permute2f128_ps(ps1, ps2, 0x31));
+        } else if (count2 == 2) {
+            const auto pd1 = _mm256_castps_pd(sum);
+            const auto pd2 = _mm256_castps_pd(diff);
+            _mm256_storeu_ps(d + m * 2, _mm256_castpd_ps(_mm256_unpacklo_pd(pd1, pd2)));
+            _mm256_storeu_ps(d + m * 2 + 8, _mm256_castpd_ps(_mm256_unpackhi_pd(pd1, pd2)));
+        } else {
+            _mm256_storeu_ps(d + m * 2, _mm256_unpacklo_ps(sum, diff));
+            _mm256_storeu_ps(d + m * 2 + 8, _mm256_unpackhi_ps(sum, diff));
+        }
+    }
+}
+
+template<std::int32_t Size>
+ACB_TARGET("avx2")
+static void RotationPassAvx2(
+    const float *s, float *d, std::int32_t count2, const float *list1, const float *list2
+) {
+    if (count2 >= 8) {
+        for (std::int32_t m = 0; m < Size / 2; s += count2 * 2, d += count2 * 2) {
+            for (std::int32_t k = 0; k < count2; k += 8, m += 8) {
+                const auto fa = _mm256_loadu_ps(s + k);
+                const auto fb = _mm256_loadu_ps(s + count2 + k);
+                const auto fc = _mm256_loadu_ps(list1 + m);
+                const auto fd = _mm256_loadu_ps(list2 + m);
+                const auto r1 = _mm256_sub_ps(_mm256_mul_ps(fa, fc), _mm256_mul_ps(fb, fd));
+                const auto r2 = _mm256_add_ps(_mm256_mul_ps(fa, fd), _mm256_mul_ps(fb, fc));
+                _mm256_storeu_ps(d + k, r1);
+                _mm256_storeu_ps(d + count2 * 2 - 8 - k, ReverseAvx2(r2));
+            }
+        }
+        return;
+    }
+
+    for (std::int32_t m = 0; m < Size / 2; m += 8, s += 16, d += 16) {
+        const auto x0 = _mm256_loadu_ps(s);
+        const auto x1 = _mm256_loadu_ps(s + 8);
+        auto fc       = _mm256_loadu_ps(list1 + m);
+        auto fd       = _mm256_loadu_ps(list2 + m);
+        if (count2 == 4) {
+            const auto fa = _mm256_permute2f128_ps(x0, x1, 0x20);
+            const auto fb = _mm256_permute2f128_ps(x0, x1, 0x31);
+            const auto r1 = _mm256_sub_ps(_mm256_mul_ps(fa, fc), _mm256_mul_ps(fb, fd));
+            const auto r2 = _mm256_add_ps(_mm256_mul_ps(fa, fd), _mm256_mul_ps(fb, fc));
+            const auto rr = _mm256_permute_ps(r2, _MM_SHUFFLE(0, 1, 2, 3));
+            _mm256_storeu_ps(d, _mm256_permute2f128_ps(r1, rr, 0x20));
+            _mm256_storeu_ps(d + 8, _mm256_permute2f128_ps(r1, rr, 0x31));
+        } else if (count2 == 2) {
+            fc            = SwapMiddlePairsAvx2(fc);
+            fd            = SwapMiddlePairsAvx2(fd);
+            const auto fa = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(1, 0, 1, 0));
+            const auto fb = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 2, 3, 2));
+            const auto r1 = _mm256_sub_ps(_mm256_mul_ps(fa, fc), _mm256_mul_ps(fb, fd));
+            const auto r2 = _mm256_add_ps(_mm256_mul_ps(fa, fd), _mm256_mul_ps(fb, fc));
+            _mm256_storeu_ps(d, _mm256_shuffle_ps(r1, r2, _MM_SHUFFLE(0, 1, 1, 0)));
+            _mm256_storeu_ps(d + 8, _mm256_shuffle_ps(r1, r2, _MM_SHUFFLE(2, 3, 3, 2)));
+        } else {
+            fc            = SwapMiddlePairsAvx2(fc);
+            fd            = SwapMiddlePairsAvx2(fd);
+            const auto fa = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto fb = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+            const auto r1 = _mm256_sub_ps(_mm256_mul_ps(fa, fc), _mm256_mul_ps(fb, fd));
+            const auto r2 = _mm256_add_ps(_mm256_mul_ps(fa, fd), _mm256_mul_ps(fb, fc));
+            _mm256_storeu_ps(d, _mm256_unpacklo_ps(r1, r2));
+            _mm256_storeu_ps(d + 8, _mm256_unpackhi_ps(r1, r2));
+        }
+    }
+}
+
+template<std::int32_t Size>
+ACB_TARGET("avx2")
+static void OverlapAddAvx2(const float *wav2, float *wav3, float *wave) {
+    constexpr auto half = Size / 2;
+    const auto *list3   = reinterpret_cast<const float *>(TransformTables<Size>::list3.data());
+    for (std::int32_t i = 0; i < half; i += 8) {
+        const auto lo    = _mm256_loadu_ps(wav2 + i);
+        const auto hi    = _mm256_loadu_ps(wav2 + half + i);
+        const auto revLo = ReverseAvx2(_mm256_loadu_ps(wav2 + half - 8 - i));
+        const auto revHi = ReverseAvx2(_mm256_loadu_ps(wav2 + Size - 8 - i));
+        const auto w1    = _mm256_mul_ps(hi, _mm256_loadu_ps(list3 + i));
+        const auto w2    = _mm256_mul_ps(_mm256_loadu_ps(list3 + half + i), revHi);
+        _mm256_storeu_ps(wave + i, _mm256_add_ps(w1, _mm256_loadu_ps(wav3 + i)));
+        _mm256_storeu_ps(wave + half + i, _mm256_sub_ps(w2, _mm256_loadu_ps(wav3 + half + i)));
+        _mm256_storeu_ps(
+            wav3 + i, _mm256_mul_ps(revLo, ReverseAvx2(_mm256_loadu_ps(list3 + Size - 8 - i)))
+        );
+        _mm256_storeu_ps(
+            wav3 + half + i, _mm256_mul_ps(ReverseAvx2(_mm256_loadu_ps(list3 + half - 8 - i)), lo)
+        );
+    }
+}
+
+template<std::int32_t Size>
+ACB_TARGET("avx2")
+static void Decode5Avx2(CHcaChannel *inst, float *wave) {
+    using Tables = TransformTables<Size>;
+    auto s       = inst->block.data();
+    auto d       = inst->wav1.data();
+    for (std::int32_t count2 = Size / 2; count2 > 0; count2 >>= 1) {
+        ButterflyPassAvx2<Size>(s, d, count2);
+        std::swap(s, d);
+    }
+    for (std::size_t i = 0; i < Tables::list1.size(); ++i) {
+        const auto count2 = std::int32_t{1} << i;
+        const auto d1     = i + 1 < Tables::list1.size() ? d : inst->wav2.data();
+        RotationPassAvx2<Size>(
+            s,
+            d1,
+            count2,
+            reinterpret_cast<const float *>(Tables::list1[i].data()),
+            reinterpret_cast<const float *>(Tables::list2[i].data())
+        );
+        std::swap(s, d);
+    }
+    OverlapAddAvx2<Size>(inst->wav2.data(), inst->wav3.data(), wave);
+}
+
+// Cross-channel Decode5: lane c of every vector belongs to channel c of a group, so each pass is
+// the loop of Decode5Scalar run on vectors, without any shuffle. Inputs are transposed in and
+// results out by 8x8 tiles, and the overlap-add is done per channel. Lanes without a channel are
+// fed zeros and their results dropped.
+
+ACB_TARGET("avx2")
+static inline void Transpose8x8Avx2(__m256 *rows) {
+    const auto t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+    const auto t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+    const auto t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+    const auto t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+    const auto t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+    const auto t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+    const auto t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+    const auto t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+    const auto u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const auto u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const auto u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const auto u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const auto u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const auto u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const auto u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const auto u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    rows[0]       = _mm256_permute2f128_ps(u0, u4, 0x20);
+    rows[1]       = _mm256_permute2f128_ps(u1, u5, 0x20);
+    rows[2]       = _mm256_permute2f128_ps(u2, u6, 0x20);
+    rows[3]       = _mm256_permute2f128_ps(u3, u7, 0x20);
+    rows[4]       = _mm256_permute2f128_ps(u0, u4, 0x31);
+    rows[5]       = _mm256_permute2f128_ps(u1, u5, 0x31);
+    rows[6]       = _mm256_permute2f128_ps(u2, u6, 0x31);
+    rows[7]       = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+// Loads floats [t, t + 8) of the blocks of up to 8 channels, one channel per row, and transposes
+// them into one bin per row.
+ACB_TARGET("avx2")
+static inline void LoadBlockTileAvx2(
+    const CHcaChannel *const *channels, std::uint32_t count, std::int32_t t, __m256 *rows
+) {
+    for (std::uint32_t c = 0; c < 8; ++c) {
+        rows[c] = c < count ? _mm256_loadu_ps(channels[c]->block.data() + t) : _mm256_setzero_ps();
+    }
+    Transpose8x8Avx2(rows);
+}
+
+// Transposes bins [t, t + 8), one per row, back into floats [t, t + 8) of wav2 of each channel.
+ACB_TARGET("avx2")
+static inline void StoreWav2TileAvx2(
+    CHcaChannel *const *channels, std::uint32_t count, std::int32_t t, __m256 *rows
+) {
+    Transpose8x8Avx2(rows);
+    for (std::uint32_t c = 0; c < count; ++c) {
+        _mm256_storeu_ps(channels[c]->wav2.data() + t, rows[c]);
+    }
+}
+
+ACB_TARGET("avx2")
+static void ButterflyPassLanesAvx2(const __m256 *s, __m256 *d, std::int32_t count2) {
+    for (std::int32_t m = 0; m < 0x40; m += count2, d += count2 * 2) {
+        for (std::int32_t k = 0; k < count2; ++k, s += 2) {
+            d[k]          = _mm256_add_ps(s[1], s[0]);
+            d[count2 + k] = _mm256_sub_ps(s[0], s[1]);
+        }
+    }
+}
+
+ACB_TARGET("avx2")
+static void RotationPassLanesAvx2(
+    const __m256 *s, __m256 *d, std::int32_t count2, const float *list1, const float *list2
+) {
+    for (std::int32_t m = 0; m < 0x40; s += count2 * 2, d += count2 * 2) {
+        for (std::int32_t k = 0; k < count2; ++k, ++m) {
+            const auto fa         = s[k];
+            const auto fb         = s[count2 + k];
+            const auto fc         = _mm256_broadcast_ss(list1 + m);
+            const auto fd         = _mm256_broadcast_ss(list2 + m);
+            d[k]                  = _mm256_sub_ps(_mm256_mul_ps(fa, fc), _mm256_mul_ps(fb, fd));
+            d[count2 * 2 - 1 - k] = _mm256_add_ps(_mm256_mul_ps(fa, fd), _mm256_mul_ps(fb, fc));
+        }
+    }
+}
+
+ACB_TARGET("avx2")
+static void
+Decode5LanesAvx2(CHcaChannel *const *channels, std::uint32_t count, std::int32_t index) {
+    __m256 buffer1[0x80];
+    __m256 buffer2[0x80];
+    for (std::int32_t t = 0; t < 0x80; t += 8) {
+        LoadBlockTileAvx2(channels, count, t, buffer1 + t);
+    }
+
+    auto s = buffer1;
+    auto d = buffer2;
+    for (std::int32_t count2 = 0x40; count2 > 0; count2 >>= 1) {
+        ButterflyPassLanesAvx2(s, d, count2);
+        std::swap(s, d);
+    }
+    for (std::size_t i = 0; i < list1Int.size(); ++i) {
+        RotationPassLanesAvx2(
+            s,
+            d,
+            std::int32_t{1} << i,
+            reinterpret_cast<const float *>(list1Int[i].data()),
+            reinterpret_cast<const float *>(list2Int[i].data())
+        );
+        std::swap(s, d);
+    }
+
+    for (std::int32_t t = 0; t < 0x80; t += 8) {
+        StoreWav2TileAvx2(channels, count, t, s + t);
+    }
+    for (std::uint32_t c = 0; c < count; ++c) {
+        const auto inst = channels[c];
+        OverlapAddAvx2<0x80>(inst->wav2.data(), inst->wav3.data(), inst->wave[index].data());
+    }
+}
+
+#endif // ACB_ARCH_X86
+
+static auto SelectChannelKernels() -> ChannelKernels {
+#ifdef ACB_ARCH_X86
+    if (CCpuFeatures::HasAvx2()) {
+        return {
+            ScaleMirroredAvx2,
+            SplitIntensityAvx2,
+            Decode5Avx2<0x80>,
+            Decode5Avx2<0x40>,
+            Decode5LanesAvx2,
+        };
+    }
+    if (CCpuFeatures::HasSse2()) {
+        return {
+            ScaleMirroredSse2, SplitIntensitySse2, Decode5Sse2<0x80>, Decode5Sse2<0x40>, nullptr
+        };
+    }
+#endif
+    return {
+        ScaleMirroredScalar,
+        SplitIntensityScalar,
+        Decode5Scalar<0x80>,
+        Decode5Scalar<0x40>,
+        nullptr,
+    };
+}
+
+static auto GetChannelKernels() -> const ChannelKernels & {
+    static const auto kernels = SelectChannelKernels();
+    return kernels;
+}
+
+void CHcaChannel::Decode5(CHcaChannel *inst, std::int32_t index) {
+    GetChannelKernels().decode5(inst, inst->wave[index].data());
+}
+
+void CHcaChannel::Decode5Half(CHcaChannel *inst, std::int32_t index) {
+    // The 8 sub-blocks of wave are contiguous.
+    GetChannelKernels().decode5Half(inst, inst->wave[0].data() + index * HalfSubBlockFrameCount);
+}
+
+void CHcaChannel::Decode5Using(Decode5Kernel kernel, CHcaChannel *inst, std::int32_t index) {
+    const auto wave = inst->wave[index].data();
+    switch (kernel) {
+#ifdef ACB_ARCH_X86
+    case Decode5Kernel::Avx2:
+        Decode5Avx2<0x80>(inst, wave);
+        break;
+    case Decode5Kernel::Sse2:
+        Decode5Sse2<0x80>(inst, wave);
+        break;
+#endif
+    default:
+        Decode5Scalar<0x80>(inst, wave);
+        break;
+    }
+}
+
+void CHcaChannel::Decode5Channels(
+    CHcaChannel *const *channels, std::uint32_t count, std::int32_t index
+) {
+    const auto &kernels = GetChannelKernels();
+    std::uint32_t i     = 0;
+    if (kernels.decode5Lanes) {
+        // Below MinLaneGroupSize channels, the transposes and the idle lanes cost more than the
+        // per-channel kernel.
+        for (; count - i >= MinLaneGroupSize; i += std::min(count - i, LaneCount)) {
+            kernels.decode5Lanes(channels + i, std::min(count - i, LaneCount), index);
+        }
+    }
+    for (; i < count; ++i) {
+        kernels.decode5(channels[i], channels[i]->wave[index].data());
+    }
+}
+
 ACB_NS_END
@@ -4,6 +4,7 @@
 #include <array>
 #include <cstdint>
 
+#include "acb_env.h"
 #include "acb_env_ns.h"
 
 ACB_NS_BEGIN
@@ -17,15 +18,39 @@ public:
 
     CHcaChannel(const CHcaChannel &) = delete;
 
-    static void Decode1(
+    /**
+     * Zeroes every field, leaving the channel as it was right after construction.
+     */
+    void Clear();
+
+    /**
+     * Value of the Type template argument of Decode1(), Decode3() and Decode4() when the type of
+     * the channel is only known at run time. Passing the actual type (0, 1 or 2) instead removes
+     * the checks on it; it must then match the type field.
+     */
+    static constexpr std::int32_t AnyType = -1;
+
+    /**
+     * Reads the scale factors of a block.
+     * @return FALSE if a delta-coded scale factor falls out of range, which only happens with
+     * corrupted data or a wrong key. The channel is left partially updated then.
+     */
+    template<std::int32_t Type = AnyType>
+    static auto Decode1(
         CHcaChannel *inst, CHcaData *data, std::uint32_t a, std::int32_t b, const std::uint8_t *ath
-    );
+    ) -> bool_t;
 
     static void Decode2(CHcaChannel *inst, CHcaData *data);
 
+    template<std::int32_t Type = AnyType>
     static void
     Decode3(CHcaChannel *inst, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d);
 
+    /**
+     * Splits intensity stereo data of inst1 into inst1 and inst2.
+     * @remarks Type is the type of inst1.
+     */
+    template<std::int32_t Type = AnyType>
     static void Decode4(
         CHcaChannel *inst1,
         CHcaChannel *inst2,
@@ -37,6 +62,41 @@ public:
 
     static void Decode5(CHcaChannel *inst, std::int32_t index);
 
+    /**
+     * Runs Decode5() on count channels.
+     * @remarks When the CPU has wide enough vectors, groups of channels are transformed together,
+     * one channel per vector lane. The results are bit-identical to Decode5().
+     */
+    static void
+    Decode5Channels(CHcaChannel *const *channels, std::uint32_t count, std::int32_t index);
+
+    /**
+     * Transforms the lower half of the spectrum only, which plays at half the sampling rate.
+     * @remarks The HalfSubBlockFrameCount samples of sub-block index are written at index *
+     * HalfSubBlockFrameCount in wave, so that the 8 sub-blocks of a block fill wave[0] to wave[3].
+     * A channel must go through either this or Decode5() for every block, not a mix of the two.
+     */
+    static void Decode5Half(CHcaChannel *inst, std::int32_t index);
+
+    static constexpr std::int32_t HalfSubBlockFrameCount = 0x40;
+
+    /**
+     * Instruction sets the kernels of Decode5() are written for.
+     */
+    enum class Decode5Kernel : std::uint32_t {
+        Scalar = 0,
+        Sse2   = 1,
+        Avx2   = 2,
+    };
+
+    /**
+     * Decode5() with a given kernel instead of the one selected for the CPU. Used to benchmark the
+     * kernels against each other.
+     * @remarks The CPU must support the kernel. On other targets than x86, every kernel runs the
+     * scalar one.
+     */
+    static void Decode5Using(Decode5Kernel kernel, CHcaChannel *inst, std::int32_t index);
+
     std::array<float, 0x80> block;
     std::array<float, 0x80> base;
     std::array<std::int8_t, 0x80> value;
@@ -0,0 +1,157 @@
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+#include "./CCpuFeatures.h"
+#include "./CHcaChecksum.h"
+
+#ifdef ACB_ARCH_X86
+#include <immintrin.h>
+#endif
+
+ACB_NS_BEGIN
+
+// Checksums are polynomials over GF(2) of degree below 16. Processing byte b updates the checksum c
+// to (c * x^8 + b * x^16) mod P, where P = x^16 + 0x8005.
+
+static constexpr std::uint32_t Polynomial = 0x18005;
+
+using SlicingTables = std::array<std::array<std::uint16_t, 0x100>, 8>;
+
+/**
+ * Table k maps a byte b to b * x^(16 + 8k) mod P, i.e. the checksum of b followed by k zero bytes.
+ */
+static constexpr auto CreateSlicingTables() -> SlicingTables {
+    SlicingTables tables = {};
+    for (std::uint32_t b = 0; b < 0x100; ++b) {
+        std::uint32_t c = b << 8u;
+        for (auto i = 0; i < 8; ++i) {
+            c = (c << 1u) ^ ((c & 0x8000u) ? Polynomial : 0u);
+        }
+        tables[0][b] = static_cast<std::uint16_t>(c);
+    }
+    for (std::uint32_t k = 1; k < 8; ++k) {
+        for (std::uint32_t b = 0; b < 0x100; ++b) {
+            const auto c = tables[k - 1][b];
+            tables[k][b] = static_cast<std::uint16_t>((c << 8u) ^ tables[0][c >> 8u]);
+        }
+    }
+    return tables;
+}
+
+static constexpr SlicingTables Tables = CreateSlicingTables();
+
+static_assert(Tables[0][0x01] == 0x8005 && Tables[0][0xff] == 0x0202);
+
+static auto ComputeSlicing(const std::uint8_t *data, std::uint32_t size, std::uint16_t checksum)
+    -> std::uint16_t {
+    for (; size >= 8; data += 8, size -= 8) {
+        // The checksum so far lines up with the first two bytes.
+        std::uint64_t v;
+        std::memcpy(&v, data, sizeof(v));
+        if constexpr (std::endian::native == std::endian::little) {
+            v = std::byteswap(v);
+        }
+        v ^= static_cast<std::uint64_t>(checksum) << 48u;
+        checksum = Tables[7][v >> 56u] ^ Tables[6][(v >> 48u) & 0xffu] ^
+                   Tables[5][(v >> 40u) & 0xffu] ^ Tables[4][(v >> 32u) & 0xffu] ^
+                   Tables[3][(v >> 24u) & 0xffu] ^ Tables[2][(v >> 16u) & 0xffu] ^
+                   Tables[1][(v >> 8u) & 0xffu] ^ Tables[0][v & 0xffu];
+    }
+    for (; size > 0; ++data, --size) {
+        checksum = (checksum << 8u) ^ Tables[0][(checksum >> 8u) ^ *data];
+    }
+    return checksum;
+}
+
+#ifdef ACB_ARCH_X86
+
+/**
+ * x^n mod P.
+ */
+static constexpr auto XPowMod(std::uint32_t n) -> std::uint64_t {
+    std::uint32_t r = 1;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        r = (r << 1u) ^ ((r & 0x8000u) ? Polynomial : 0u);
+    }
+    return r;
+}
+
+// Folding with PCLMULQDQ. 16 bytes of data, read as a big-endian 128-bit polynomial X = H * x^64 +
+// L, are carried over d bits of following data as H * (x^(d + 64) mod P) + L * (x^d mod P), which
+// is congruent to X * x^d and still fits in 128 bits. Four 16-byte lanes are folded 64 bytes at a
+// time, merged into one, and the last 16-byte value is reduced with the tables together with the
+// remaining bytes.
+
+ACB_TARGET("ssse3,pclmul")
+static inline auto LoadBigEndian(const std::uint8_t *data) -> __m128i {
+    const auto reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), reverse);
+}
+
+ACB_TARGET("ssse3,pclmul")
+static inline auto Fold(__m128i x, __m128i k) -> __m128i {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+ACB_TARGET("ssse3,pclmul")
+static auto ComputePclmul(const std::uint8_t *data, std::uint32_t size, std::uint16_t checksum)
+    -> std::uint16_t {
+    constexpr auto k128High = static_cast<std::int64_t>(XPowMod(128 + 64));
+    constexpr auto k128Low  = static_cast<std::int64_t>(XPowMod(128));
+    constexpr auto k512High = static_cast<std::int64_t>(XPowMod(512 + 64));
+    constexpr auto k512Low  = static_cast<std::int64_t>(XPowMod(512));
+    const auto k128         = _mm_set_epi64x(k128High, k128Low);
+    const auto k512         = _mm_set_epi64x(k512High, k512Low);
+
+    // Adding the checksum so far to the first 16 bits of data is the same as starting from it.
+    const auto initial = static_cast<std::int64_t>(static_cast<std::uint64_t>(checksum) << 48u);
+
+    auto x0 = _mm_xor_si128(LoadBigEndian(data), _mm_set_epi64x(initial, 0));
+    auto x1 = LoadBigEndian(data + 0x10);
+    auto x2 = LoadBigEndian(data + 0x20);
+    auto x3 = LoadBigEndian(data + 0x30);
+    data += 0x40;
+    size -= 0x40;
+
+    for (; size >= 0x40; data += 0x40, size -= 0x40) {
+        x0 = _mm_xor_si128(Fold(x0, k512), LoadBigEndian(data));
+        x1 = _mm_xor_si128(Fold(x1, k512), LoadBigEndian(data + 0x10));
+        x2 = _mm_xor_si128(Fold(x2, k512), LoadBigEndian(data + 0x20));
+        x3 = _mm_xor_si128(Fold(x3, k512), LoadBigEndian(data + 0x30));
+    }
+
+    x1     = _mm_xor_si128(Fold(x0, k128), x1);
+    x2     = _mm_xor_si128(Fold(x1, k128), x2);
+    auto x = _mm_xor_si128(Fold(x2, k128), x3);
+    for (; size >= 0x10; data += 0x10, size -= 0x10) {
+        x = _mm_xor_si128(Fold(x, k128), LoadBigEndian(data));
+    }
+
+    // The checksum of X followed by the remaining bytes, starting from 0.
+    const auto reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    std::array<std::uint8_t, 0x20> rest;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rest.data()), _mm_shuffle_epi8(x, reverse));
+    std::memcpy(rest.data() + 0x10, data, size);
+    return ComputeSlicing(rest.data(), 0x10 + size, 0);
+}
+
+#endif // ACB_ARCH_X86
+
+auto CHcaChecksum::Compute(const void *data, std::uint32_t size, std::uint16_t initialValue)
+    -> std::uint16_t {
+    const auto bytes = static_cast<const std::uint8_t *>(data);
+#ifdef ACB_ARCH_X86
+    static const auto hasPclmul = CCpuFeatures::HasPclmul();
+    if (size >= LongDataSize && hasPclmul) {
+        return ComputePclmul(bytes, size, initialValue);
+    }
+#endif
+    return ComputeSlicing(bytes, size, initialValue);
+}
+
+ACB_NS_END
@@ -0,0 +1,39 @@
+#ifndef ACB_KAWASHIMA_HCA_CHCACHECKSUM_H_
+#define ACB_KAWASHIMA_HCA_CHCACHECKSUM_H_
+
+#include <cstdint>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+ACB_NS_BEGIN
+
+/**
+ * The CRC-16 used by HCA headers and blocks: polynomial 0x8005, most significant bit first, no
+ * reflection and no final XOR.
+ * @remarks A header or block ends with the big-endian checksum of the bytes before it, so the
+ * checksum of the whole header or block is 0 when it is intact. Data of at least LongDataSize bytes
+ * is folded with PCLMULQDQ when the CPU supports it; everything else goes through slicing-by-8
+ * tables.
+ */
+class CHcaChecksum final {
+
+public:
+    /**
+     * Computes the checksum of data.
+     * @param data The data.
+     * @param size Size of data.
+     * @param initialValue Checksum of the data before it, or 0 for none.
+     * @return The checksum.
+     */
+    static auto Compute(const void *data, std::uint32_t size, std::uint16_t initialValue = 0)
+        -> std::uint16_t;
+
+    static constexpr std::uint32_t LongDataSize = 0x40;
+
+    PURE_STATIC(CHcaChecksum);
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CHCACHECKSUM_H_
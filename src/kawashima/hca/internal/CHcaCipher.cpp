@@ -1,11 +1,22 @@
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
 
 #include "acb_cdata.h"
 
+#include "./CCpuFeatures.h"
 #include "./CHcaCipher.h"
 
+#ifdef ACB_ARCH_X86
+#include <immintrin.h>
+#endif
+
 static void TransformKey(
     std::uint32_t key1,
     std::uint32_t key2,
@@ -30,85 +41,221 @@ static void TransformKey(
 ACB_NS_BEGIN
 
 CHcaCipher::CHcaCipher() {
-    Init(CHcaCipherConfig(HcaCipherType::NoCipher));
+    Init(CHcaCipherConfig(HcaCipherType::NoCipher), TRUE);
 }
 
 CHcaCipher::CHcaCipher(const HCA_CIPHER_CONFIG &config) {
     CHcaCipherConfig cfg(config.key.key, config.keyModifier);
-    Init(cfg);
+    Init(cfg, TRUE);
 }
 
 CHcaCipher::CHcaCipher(const CHcaCipherConfig &config) {
-    Init(config);
+    Init(config, TRUE);
+}
+
+CHcaCipher::CHcaCipher(const CHcaCipherConfig &config, bool_t shareTables) {
+    Init(config, shareTables);
 }
 
 CHcaCipher::CHcaCipher(const CHcaCipher &other) {
-    _cipherType   = other._cipherType;
-    _decryptTable = other._decryptTable;
-    _encryptTable = other._encryptTable;
+    _cipherType = other._cipherType;
+    _tables     = other._tables;
 }
 
-auto CHcaCipher::Init(const CHcaCipherConfig &config) -> bool_t {
+auto CHcaCipher::CreateUnshared(const HCA_CIPHER_CONFIG &config) -> CHcaCipher {
+    return {CHcaCipherConfig(config.key.key, config.keyModifier), FALSE};
+}
+
+auto CHcaCipher::Init(const CHcaCipherConfig &config, bool_t shareTables) -> bool_t {
     auto type = config.cipherType;
 
     if (config.key.key == 0 && type == HcaCipherType::WithKey) {
         type = HcaCipherType::NoCipher;
     }
 
-    std::uint32_t key1 = config.key.keyParts.key1, key2 = config.key.keyParts.key2;
+    // Only keyed tables depend on the key.
+    std::uint32_t key1 = 0, key2 = 0;
+    std::uint16_t keyModifier = 0;
+    if (type == HcaCipherType::WithKey) {
+        key1        = config.key.keyParts.key1;
+        key2        = config.key.keyParts.key2;
+        keyModifier = config.keyModifier;
+    }
+
+    _cipherType = type;
+    _tables     = shareTables ? GetTables(type, key1, key2, keyModifier)
+                              : CreateTables(type, key1, key2, keyModifier);
+
+    return TRUE;
+}
+
+auto CHcaCipher::GetTables(
+    HcaCipherType type, std::uint32_t key1, std::uint32_t key2, std::uint16_t keyModifier
+) -> std::shared_ptr<const CipherTables> {
+    using CacheKey = std::tuple<HcaCipherType, std::uint32_t, std::uint32_t, std::uint16_t>;
+    struct CacheEntry {
+        std::shared_ptr<const CipherTables> tables;
+        // Value of useCount when the entry was last looked up or stored.
+        std::uint64_t lastUse;
+    };
+    static std::mutex cacheMutex;
+    static std::map<CacheKey, CacheEntry> cache;
+    static std::uint64_t useCount = 0;
 
-    if (config.key.key != 0 && type == HcaCipherType::WithKey && config.keyModifier) {
-        TransformKey(key1, key2, config.keyModifier, &key1, &key2);
+    const CacheKey cacheKey(type, key1, key2, keyModifier);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        const auto item = cache.find(cacheKey);
+        if (item != cache.end()) {
+            item->second.lastUse = ++useCount;
+            return item->second.tables;
+        }
+    }
+
+    // Built outside of the lock. If another thread builds the same tables meanwhile, the first
+    // ones stored win, and both are identical anyway.
+    auto tables = CreateTables(type, key1, key2, keyModifier);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const auto [item, inserted] = cache.try_emplace(cacheKey, CacheEntry{std::move(tables), 0});
+    item->second.lastUse        = ++useCount;
+    if (inserted && cache.size() > TableCacheCapacity) {
+        // Evict the least recently used entry. Ciphers still using its tables keep them alive.
+        const auto oldest =
+            std::min_element(cache.begin(), cache.end(), [](const auto &a, const auto &b) {
+                return a.second.lastUse < b.second.lastUse;
+            });
+        cache.erase(oldest);
+    }
+    return item->second.tables;
+}
+
+auto CHcaCipher::CreateTables(
+    HcaCipherType type, std::uint32_t key1, std::uint32_t key2, std::uint16_t keyModifier
+) -> std::shared_ptr<const CipherTables> {
+    auto tables = std::make_shared<CipherTables>();
+
+    if (type == HcaCipherType::WithKey && keyModifier) {
+        TransformKey(key1, key2, keyModifier, &key1, &key2);
     }
 
     switch (type) {
     case HcaCipherType::NoCipher:
-        Init0();
+        Init0(tables->decryptTable);
         break;
     case HcaCipherType::Static:
-        Init1();
+        Init1(tables->decryptTable);
         break;
     case HcaCipherType::WithKey:
-        Init56(key1, key2);
+        Init56(tables->decryptTable, key1, key2);
         break;
     }
 
-    _cipherType = type;
+    InitEncryptTable(*tables);
+    return tables;
+}
+
+// Byte substitution kernels: data[i] = table[data[i]] over a 256-entry table.
+
+using SubstituteFunc = void (*)(const std::uint8_t *table, std::uint8_t *data, std::uint32_t size);
 
-    return InitEncryptTable();
+static void SubstituteScalar(const std::uint8_t *table, std::uint8_t *data, std::uint32_t size) {
+    for (std::uint8_t *d = data; size > 0; d++, size--) {
+        *d = table[*d];
+    }
+}
+
+#ifdef ACB_ARCH_X86
+
+// Table lookups through PSHUFB need 16 lookups per vector, one for each row of 16 entries, and
+// turn out no faster than the scalar loop, so only VBMI gets a vector kernel.
+//
+// VPERMI2B looks up 128 entries at once from two registers: one lookup for each half of the table,
+// then bit 7 of the index picks between them. The tail is handled with masked loads and stores.
+
+ACB_TARGET("avx512f,avx512bw,avx512vbmi")
+static void SubstituteAvx512Vbmi(
+    const std::uint8_t *table, std::uint8_t *data, std::uint32_t size
+) {
+    const auto t0 = _mm512_loadu_si512(table);
+    const auto t1 = _mm512_loadu_si512(table + 0x40);
+    const auto t2 = _mm512_loadu_si512(table + 0x80);
+    const auto t3 = _mm512_loadu_si512(table + 0xc0);
+
+    std::uint32_t i = 0;
+    for (; i < size; i += 0x40) {
+        const auto rest   = size - i;
+        const auto mask   = rest >= 0x40 ? ~__mmask64{0} : ~__mmask64{0} >> (0x40 - rest);
+        const auto x      = _mm512_maskz_loadu_epi8(mask, data + i);
+        const auto low    = _mm512_permutex2var_epi8(t0, x, t1);
+        const auto high   = _mm512_permutex2var_epi8(t2, x, t3);
+        const auto result = _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), low, high);
+        _mm512_mask_storeu_epi8(data + i, mask, result);
+    }
+}
+
+#endif // ACB_ARCH_X86
+
+static auto SelectSubstituteFunc() -> SubstituteFunc {
+#ifdef ACB_ARCH_X86
+    if (CCpuFeatures::HasAvx512Vbmi()) {
+        return SubstituteAvx512Vbmi;
+    }
+#endif
+    return SubstituteScalar;
+}
+
+void CHcaCipher::Substitute(
+    const std::array<std::uint8_t, TableSize> &table, std::uint8_t *data, std::uint32_t size
+) {
+    static const SubstituteFunc substitute = SelectSubstituteFunc();
+    substitute(table.data(), data, size);
 }
 
 void CHcaCipher::Decrypt(std::uint8_t *data, std::uint32_t size) const {
-    for (std::uint8_t *d = data; size > 0; d++, size--) {
-        *d = _decryptTable[*d];
+    if (_cipherType == HcaCipherType::NoCipher) {
+        // Both tables are the identity.
+        return;
     }
+    Substitute(_tables->decryptTable, data, size);
 }
 
 void CHcaCipher::Encrypt(std::uint8_t *data, std::uint32_t size) const {
-    for (std::uint8_t *d = data; size > 0; d++, size--) {
-        *d = _encryptTable[*d];
+    if (_cipherType == HcaCipherType::NoCipher) {
+        return;
     }
+    Substitute(_tables->encryptTable, data, size);
 }
 
-void CHcaCipher::Init0() {
+auto CHcaCipher::GetDecryptTable() const -> const std::array<std::uint8_t, TableSize> & {
+    return _tables->decryptTable;
+}
+
+auto CHcaCipher::GetEncryptTable() const -> const std::array<std::uint8_t, TableSize> & {
+    return _tables->encryptTable;
+}
+
+void CHcaCipher::Init0(std::array<std::uint8_t, TableSize> &decryptTable) {
     for (std::uint32_t i = 0; i < TableSize; i++) {
-        _decryptTable[i] = (std::uint8_t)i;
+        decryptTable[i] = (std::uint8_t)i;
     }
 }
 
-void CHcaCipher::Init1() {
+void CHcaCipher::Init1(std::array<std::uint8_t, TableSize> &decryptTable) {
     for (std::uint32_t i = 1, v = 0; i < 0xFF; i++) {
         v = (v * 13u + 11u) & 0xFFu;
         if (v == 0 || v == 0xFF) {
             v = (v * 13u + 11u) & 0xFFu;
         }
-        _decryptTable[i] = (std::uint8_t)v;
+        decryptTable[i] = (std::uint8_t)v;
     }
-    _decryptTable[0]    = 0;
-    _decryptTable[0xFF] = 0xFF;
+    decryptTable[0]    = 0;
+    decryptTable[0xFF] = 0xFF;
 }
 
-void CHcaCipher::Init56(std::uint32_t key1, std::uint32_t key2) {
+void CHcaCipher::Init56(
+    std::array<std::uint8_t, TableSize> &decryptTable, std::uint32_t key1, std::uint32_t key2
+) {
     // Generate table #1
     std::array<std::uint8_t, 8> t1;
     if (!key1) {
@@ -156,7 +303,7 @@ void CHcaCipher::Init56(std::uint32_t key1, std::uint32_t key2) {
     }
 
     // Generate CIPH table
-    t = _decryptTable.begin() + 1;
+    t = decryptTable.begin() + 1;
     for (std::uint32_t i = 0, v = 0; i < TableSize; i++) {
         v              = (v + 0x11u) & 0xFFu;
         std::uint8_t a = t3[v];
@@ -164,8 +311,8 @@ void CHcaCipher::Init56(std::uint32_t key1, std::uint32_t key2) {
             *(t++) = a;
         }
     }
-    _decryptTable[0]    = 0;
-    _decryptTable[0xFF] = 0xFF;
+    decryptTable[0]    = 0;
+    decryptTable[0xFF] = 0xFF;
 }
 
 void CHcaCipher::Init56_CreateTable(std::array<std::uint8_t, 0x10> &r, std::uint8_t key) {
@@ -179,12 +326,11 @@ void CHcaCipher::Init56_CreateTable(std::array<std::uint8_t, 0x10> &r, std::uint
     }
 }
 
-auto CHcaCipher::InitEncryptTable() -> bool_t {
-    _encryptTable.fill(0);
+void CHcaCipher::InitEncryptTable(CipherTables &tables) {
+    tables.encryptTable.fill(0);
     for (std::uint32_t i = 0; i < TableSize; ++i) {
-        _encryptTable[_decryptTable[i]] = (std::uint8_t)i;
+        tables.encryptTable[tables.decryptTable[i]] = (std::uint8_t)i;
     }
-    return TRUE;
 }
 
 ACB_NS_END
@@ -2,7 +2,9 @@
 #define ACB_KAWASHIMA_HCA_CHCACIPHER_H_
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 
 #include "acb_cdata.h"
 #include "acb_enum.h"
@@ -11,6 +13,12 @@
 
 ACB_NS_BEGIN
 
+/**
+ * Decrypts and encrypts HCA blocks with the tables of a cipher type and key.
+ * @remarks The tables are immutable and shared: ciphers created with the same type, key and key
+ * modifier, on any thread, reuse the tables built by the first one. CreateUnshared() is the
+ * exception.
+ */
 class CHcaCipher {
 
 public:
@@ -22,27 +30,73 @@ public:
 
     CHcaCipher(const CHcaCipher &);
 
-    auto InitEncryptTable() -> bool_t;
+    auto operator=(const CHcaCipher &) -> CHcaCipher & = default;
+
+    /**
+     * Creates a cipher with tables of its own, without looking up or filling the shared cache.
+     * Meant for short-lived ciphers, e.g. to try many candidate keys, which would otherwise evict
+     * the tables of the keys in use.
+     */
+    [[nodiscard]] static auto CreateUnshared(const HCA_CIPHER_CONFIG &config) -> CHcaCipher;
 
     void Decrypt(std::uint8_t *data, std::uint32_t size) const;
 
     void Encrypt(std::uint8_t *data, std::uint32_t size) const;
 
+    static constexpr std::uint32_t TableSize = 0x100;
+
+    [[nodiscard]] auto GetDecryptTable() const -> const std::array<std::uint8_t, TableSize> &;
+
+    [[nodiscard]] auto GetEncryptTable() const -> const std::array<std::uint8_t, TableSize> &;
+
+    /**
+     * Replaces every byte of data with its entry in a substitution table, using AVX-512 VBMI when
+     * the CPU supports it.
+     * @param table The substitution table.
+     * @param data Data to transform in place.
+     * @param size Size of data.
+     */
+    static void Substitute(
+        const std::array<std::uint8_t, TableSize> &table, std::uint8_t *data, std::uint32_t size
+    );
+
 private:
-    auto Init(const CHcaCipherConfig &config) -> bool_t;
+    struct CipherTables {
+        std::array<std::uint8_t, TableSize> decryptTable;
+        std::array<std::uint8_t, TableSize> encryptTable;
+    };
 
-    static constexpr std::uint32_t TableSize = 0x100;
+    // Number of table pairs kept by the cache. The least recently used pair is evicted beyond it.
+    static constexpr std::size_t TableCacheCapacity = 0x40;
+
+    CHcaCipher(const CHcaCipherConfig &config, bool_t shareTables);
+
+    auto Init(const CHcaCipherConfig &config, bool_t shareTables) -> bool_t;
+
+    /**
+     * Gets the tables of a cipher from the process-wide cache, building them on first use.
+     */
+    static auto GetTables(
+        HcaCipherType type, std::uint32_t key1, std::uint32_t key2, std::uint16_t keyModifier
+    ) -> std::shared_ptr<const CipherTables>;
+
+    static auto CreateTables(
+        HcaCipherType type, std::uint32_t key1, std::uint32_t key2, std::uint16_t keyModifier
+    ) -> std::shared_ptr<const CipherTables>;
+
+    static void Init0(std::array<std::uint8_t, TableSize> &decryptTable);
 
-    std::array<std::uint8_t, TableSize> _decryptTable;
-    std::array<std::uint8_t, TableSize> _encryptTable;
+    static void Init1(std::array<std::uint8_t, TableSize> &decryptTable);
 
-    void Init0();
+    static void Init56(
+        std::array<std::uint8_t, TableSize> &decryptTable, std::uint32_t key1, std::uint32_t key2
+    );
 
-    void Init1();
+    static void Init56_CreateTable(std::array<std::uint8_t, 0x10> &table, std::uint8_t key);
 
-    void Init56(std::uint32_t key1, std::uint32_t key2);
+    static void InitEncryptTable(CipherTables &tables);
 
-    void Init56_CreateTable(std::array<std::uint8_t, 0x10> &table, std::uint8_t key);
+    std::shared_ptr<const CipherTables> _tables;
 
     HcaCipherType _cipherType;
 };
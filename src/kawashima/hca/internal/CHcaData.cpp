@@ -1,6 +1,6 @@
-#include <array>
-#include <cstddef>
+#include <bit>
 #include <cstdint>
+#include <cstring>
 
 #include "acb_env_ns.h"
 
@@ -13,36 +13,21 @@ CHcaData::CHcaData(std::uint8_t *data, std::uint32_t dataSize, std::int32_t size
     _dataSize = dataSize;
     _size     = size * 8 - 16;
     _bit      = 0;
+    _cache    = 0;
+    // Forces a refill on the first read.
+    _cacheBit = -64;
 }
 
-auto CHcaData::CheckBit(std::int32_t bitSize) -> std::int32_t {
-#define SAFE_ACCESS(array, length, index) (((index) < (length)) ? (array)[(index)] : 0)
-
-    std::int32_t v = 0;
-    if (_bit + bitSize <= _size) {
-        static std::array<std::int32_t, 8> mask = {
-            0xFFFFFF, 0x7FFFFF, 0x3FFFFF, 0x1FFFFF, 0x0FFFFF, 0x07FFFF, 0x03FFFF, 0x01FFFF
-        };
-        std::size_t i = _bit >> 3;
-        v             = SAFE_ACCESS(_data, _dataSize, i);
-        v             = (v << 8) | SAFE_ACCESS(_data, _dataSize, i + 1);
-        v             = (v << 8) | SAFE_ACCESS(_data, _dataSize, i + 2);
-        v &= mask[_bit & 7];
-        v >>= 24 - (_bit & 7) - static_cast<std::int32_t>(bitSize);
+void CHcaData::Refill() {
+    // Only called for reads that end within _size, so the load stays within the block and its
+    // padding.
+    std::uint64_t v;
+    std::memcpy(&v, _data + (_bit >> 3), sizeof(v));
+    if constexpr (std::endian::native == std::endian::little) {
+        v = std::byteswap(v);
     }
-    return v;
-
-#undef SAFE_ACCESS
-}
-
-auto CHcaData::GetBit(std::int32_t bitSize) -> std::int32_t {
-    std::int32_t v = CheckBit(bitSize);
-    _bit += bitSize;
-    return v;
-}
-
-void CHcaData::AddBit(std::int32_t bitSize) {
-    _bit += bitSize;
+    _cache    = v;
+    _cacheBit = _bit & ~7;
 }
 
 ACB_NS_END
@@ -7,24 +7,71 @@
 
 ACB_NS_BEGIN
 
+/**
+ * Big-endian bit reader over an HCA block.
+ * @remarks Up to 64 bits are cached and refilled with a single unaligned load, so the buffer must
+ * be followed by PaddingSize readable bytes. Those bytes must be zero, because reads that end past
+ * the block are defined to see zeros.
+ */
 class CHcaData {
 
 public:
+    /**
+     * Number of zeroed bytes that must follow the block in the buffer passed to the constructor.
+     */
+    static constexpr std::uint32_t PaddingSize = 8;
+
     CHcaData(std::uint8_t *data, std::uint32_t dataSize, std::int32_t size);
 
     CHcaData(CHcaData &) = default;
 
-    auto CheckBit(std::int32_t bitSize) -> std::int32_t;
+    auto CheckBit(std::int32_t bitSize) -> std::int32_t {
+        if (_bit + bitSize > _size) {
+            return 0;
+        }
+        // Refill before offset reaches 64, which would make the shift below undefined.
+        auto offset = _bit - _cacheBit;
+        if (offset < 0 || offset + bitSize >= 64) {
+            Refill();
+            offset = _bit - _cacheBit;
+        }
+        // Shifting twice keeps the shift count below 64 when bitSize is 0.
+        return static_cast<std::int32_t>(((_cache << offset) >> 1) >> (63 - bitSize));
+    }
+
+    auto GetBit(std::int32_t bitSize) -> std::int32_t {
+        std::int32_t v = CheckBit(bitSize);
+        _bit += bitSize;
+        return v;
+    }
 
-    auto GetBit(std::int32_t bitSize) -> std::int32_t;
+    void AddBit(std::int32_t bitSize) {
+        _bit += bitSize;
+    }
 
-    void AddBit(std::int32_t bitSize);
+    /**
+     * Gets the number of bits consumed so far. It exceeds GetSize() once reads went past the data.
+     */
+    [[nodiscard]] auto GetPosition() const -> std::int32_t {
+        return _bit;
+    }
+
+    /**
+     * Gets the number of bits of data, i.e. the block without its checksum.
+     */
+    [[nodiscard]] auto GetSize() const -> std::int32_t {
+        return _size;
+    }
 
 private:
+    void Refill();
+
     std::uint8_t *_data;
     std::uint32_t _dataSize;
     std::int32_t _size;
     std::int32_t _bit;
+    std::uint64_t _cache;
+    std::int32_t _cacheBit;
 };
 
 ACB_NS_END
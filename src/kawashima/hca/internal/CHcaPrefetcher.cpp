@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+#include "acb_env_ns.h"
+#include "takamori/exceptions/CArgumentException.h"
+
+#include "./CHcaPrefetcher.h"
+
+ACB_NS_BEGIN
+
+CHcaPrefetcher::CHcaPrefetcher(
+    std::uint32_t blockCount, std::uint32_t blockSize, std::uint32_t capacity,
+    DecodeFunc decodeFunc
+)
+    : _blockCount(blockCount), _blockSize(blockSize),
+      _capacity(std::max(std::min(capacity, blockCount), 1u)),
+      _decodeFunc(std::move(decodeFunc)), _startBlock(0), _endBlock(0), _generation(0),
+      _stopping(FALSE) {
+    _ringBuffer = new std::uint8_t[static_cast<std::size_t>(_capacity) * blockSize];
+    _worker     = std::thread(&CHcaPrefetcher::Run, this);
+}
+
+CHcaPrefetcher::~CHcaPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = TRUE;
+    }
+    _workerCondition.notify_one();
+    _worker.join();
+
+    if (_ringBuffer) {
+        delete[] _ringBuffer;
+        _ringBuffer = nullptr;
+    }
+}
+
+auto CHcaPrefetcher::Acquire(std::uint32_t blockIndex) -> const std::uint8_t * {
+    if (blockIndex >= _blockCount) {
+        throw CArgumentException("CHcaPrefetcher::Acquire");
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    MoveTo(blockIndex);
+    _readerCondition.wait(lock, [this, blockIndex] {
+        return _endBlock > blockIndex || _error;
+    });
+    if (_endBlock <= blockIndex) {
+        // Let the next request try the block again.
+        const auto error = _error;
+        _error           = nullptr;
+        ++_generation;
+        _workerCondition.notify_one();
+        std::rethrow_exception(error);
+    }
+    return GetSlotData(blockIndex);
+}
+
+void CHcaPrefetcher::Seek(std::uint32_t blockIndex) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    MoveTo(blockIndex);
+}
+
+void CHcaPrefetcher::MoveTo(std::uint32_t blockIndex) {
+    if (blockIndex < _startBlock || blockIndex > _endBlock) {
+        // Outside of the decoded range: drop everything and start over.
+        _startBlock = _endBlock = blockIndex;
+        _error                  = nullptr;
+        ++_generation;
+    } else {
+        _startBlock = blockIndex;
+    }
+    _workerCondition.notify_one();
+}
+
+auto CHcaPrefetcher::GetSlotData(std::uint32_t blockIndex) const -> std::uint8_t * {
+    return _ringBuffer + static_cast<std::size_t>(blockIndex % _capacity) * _blockSize;
+}
+
+void CHcaPrefetcher::Run() {
+    // The block last decoded successfully, whatever generation it belonged to.
+    std::uint32_t lastDecoded = 0;
+    bool_t hasDecoded         = FALSE;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _workerCondition.wait(lock, [this] {
+            return _stopping ||
+                   (!_error && _endBlock < _blockCount && _endBlock - _startBlock < _capacity);
+        });
+        if (_stopping) {
+            break;
+        }
+
+        const auto generation = _generation;
+        const auto blockIndex = _endBlock;
+        const auto continued  = static_cast<bool_t>(hasDecoded && lastDecoded + 1 == blockIndex);
+        std::exception_ptr error;
+        lock.unlock();
+
+        // The slot of blockIndex is not readable until _endBlock passes it, and the reader never
+        // moves the window past it without starting a new generation.
+        try {
+            _decodeFunc(blockIndex, continued, GetSlotData(blockIndex));
+            lastDecoded = blockIndex;
+            hasDecoded  = TRUE;
+        } catch (...) {
+            error      = std::current_exception();
+            hasDecoded = FALSE;
+        }
+
+        lock.lock();
+        if (generation != _generation) {
+            // Cancelled while decoding.
+            continue;
+        }
+        if (error) {
+            _error = error;
+        } else {
+            ++_endBlock;
+        }
+        _readerCondition.notify_all();
+    }
+}
+
+ACB_NS_END
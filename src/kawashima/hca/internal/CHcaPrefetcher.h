@@ -0,0 +1,103 @@
+#ifndef ACB_KAWASHIMA_HCA_CHCAPREFETCHER_H_
+#define ACB_KAWASHIMA_HCA_CHCAPREFETCHER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+ACB_NS_BEGIN
+
+/**
+ * Decodes blocks ahead of the reader on a worker thread, into a bounded ring of wave blocks.
+ * @remarks The worker decodes blocks in order, starting from the block last requested, until the
+ * ring is full. Requesting a block outside of the decoded range restarts the worker from that
+ * block, and any block being decoded for the old range is discarded.
+ */
+class CHcaPrefetcher final {
+
+public:
+    /**
+     * Decodes one block into a wave block buffer. Called on the worker thread only.
+     * @param blockIndex Index of the block.
+     * @param continued Whether the previous call decoded blockIndex - 1 successfully, in which case
+     * the decoder state is already right for blockIndex.
+     * @param waveBlockBuffer Destination buffer.
+     */
+    using DecodeFunc = std::function<
+        void(std::uint32_t blockIndex, bool_t continued, std::uint8_t *waveBlockBuffer)>;
+
+    /**
+     * @param blockCount Total number of blocks.
+     * @param blockSize Size of each wave block.
+     * @param capacity Number of blocks in the ring. It is raised to 1 and capped at blockCount.
+     * @param decodeFunc Block decode function.
+     */
+    CHcaPrefetcher(
+        std::uint32_t blockCount, std::uint32_t blockSize, std::uint32_t capacity,
+        DecodeFunc decodeFunc
+    );
+
+    CHcaPrefetcher(const CHcaPrefetcher &) = delete;
+
+    auto operator=(const CHcaPrefetcher &) -> CHcaPrefetcher & = delete;
+
+    ~CHcaPrefetcher();
+
+    /**
+     * Gets a decoded block, waiting for the worker if it is not decoded yet. Blocks before it are
+     * released for reuse.
+     * @remarks Rethrows the exception thrown while decoding the block, if any.
+     * @param blockIndex Index of the block.
+     * @return The block data. It stays valid until the next call to Acquire() or Seek().
+     */
+    auto Acquire(std::uint32_t blockIndex) -> const std::uint8_t *;
+
+    /**
+     * Tells the worker that the reader is about to continue at a block. If the block is outside of
+     * the decoded range, the current work is cancelled and the worker starts over from the block.
+     * @param blockIndex Index of the block.
+     */
+    void Seek(std::uint32_t blockIndex);
+
+private:
+    void Run();
+
+    /**
+     * Moves the window to start at a block, restarting the worker if the block has not been
+     * decoded and is not being decoded. Must be called with _mutex held.
+     */
+    void MoveTo(std::uint32_t blockIndex);
+
+    auto GetSlotData(std::uint32_t blockIndex) const -> std::uint8_t *;
+
+    std::uint32_t _blockCount;
+    std::uint32_t _blockSize;
+    std::uint32_t _capacity;
+    DecodeFunc _decodeFunc;
+    std::uint8_t *_ringBuffer;
+
+    std::mutex _mutex;
+    // Signalled when the worker has work to do or must stop.
+    std::condition_variable _workerCondition;
+    // Signalled when a block is decoded or fails to decode.
+    std::condition_variable _readerCondition;
+    // Blocks in [_startBlock, _endBlock) are decoded. The worker decodes _endBlock next.
+    std::uint32_t _startBlock;
+    std::uint32_t _endBlock;
+    // Changes on every restart, so that the worker can tell its current block has been cancelled.
+    std::uint64_t _generation;
+    // The error of decoding _endBlock in the current generation, if any.
+    std::exception_ptr _error;
+    bool_t _stopping;
+    std::thread _worker;
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CHCAPREFETCHER_H_
@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "acb_cdata.h"
+#include "acb_enum.h"
+#include "acb_env_ns.h"
+#include "kawashima/hca/CDefaultWaveGenerator.h"
+
+#include "./CCpuFeatures.h"
+#include "./CHcaWaveWriter.h"
+
+#ifdef ACB_ARCH_X86
+#include <immintrin.h>
+#endif
+
+ACB_NS_BEGIN
+
+template<HcaWaveFormat Format>
+static constexpr std::uint32_t SampleSize = Format == HcaWaveFormat::U8    ? 1
+                                            : Format == HcaWaveFormat::S16 ? 2
+                                            : Format == HcaWaveFormat::S24 ? 3
+                                                                           : 4;
+
+// Scalar converters. These follow CDefaultWaveGenerator exactly.
+
+template<HcaWaveFormat Format>
+static inline void WriteSample(float data, std::uint8_t *buffer) {
+    if constexpr (Format == HcaWaveFormat::U8) {
+        *buffer = (std::uint8_t)((std::int32_t)(data * 0x7f) + 0x80);
+    } else if constexpr (Format == HcaWaveFormat::S16) {
+        const auto i = (std::int16_t)(data * 0x7fff);
+        std::memcpy(buffer, &i, sizeof(i));
+    } else if constexpr (Format == HcaWaveFormat::S24) {
+        // Low 3 bytes of the 32-bit integer, in memory order.
+        const auto i = (std::int32_t)(data * 0x7fffff);
+        std::memcpy(buffer, &i, 3);
+    } else if constexpr (Format == HcaWaveFormat::S32) {
+        const auto i = (std::int32_t)((double)data * 0x7fffffff);
+        std::memcpy(buffer, &i, sizeof(i));
+    } else {
+        std::memcpy(buffer, &data, sizeof(data));
+    }
+}
+
+// Block converters take the channel count as a template argument as well. 0 means any count, given
+// at runtime; other values make every loop bound a constant.
+
+template<HcaWaveFormat Format, std::uint32_t Channels>
+static void WriteBlockScalar(
+    const float *const *channelWaves, std::uint32_t channelCount, std::uint32_t frameCount,
+    float volume, std::uint8_t *buffer
+) {
+    if constexpr (Channels != 0) {
+        channelCount = Channels;
+    }
+    for (std::uint32_t i = 0; i < frameCount; ++i) {
+        for (std::uint32_t k = 0; k < channelCount; ++k) {
+            const auto f = std::clamp(channelWaves[k][i] * volume, -1.0f, 1.0f);
+            WriteSample<Format>(f, buffer);
+            buffer += SampleSize<Format>;
+        }
+    }
+}
+
+#ifdef ACB_ARCH_X86
+
+// The vector converters produce one 32-bit integer per sample (the raw bits for float output)
+// whose low bytes, in little-endian order, are the output sample. Clamping uses max(lo, v) and
+// min(hi, v) with v as the second operand, so NaN passes through like it does in std::clamp, and
+// truncating conversions match the C casts for every input.
+
+// SSE2 kernels: 4 samples per vector.
+
+template<HcaWaveFormat Format>
+ACB_TARGET("sse2")
+static inline auto QuantizeSse2(__m128 wave, __m128 volume) -> __m128i {
+    auto f = _mm_mul_ps(wave, volume);
+    f      = _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_set1_ps(-1.0f), f));
+    if constexpr (Format == HcaWaveFormat::U8) {
+        const auto i = _mm_cvttps_epi32(_mm_mul_ps(f, _mm_set1_ps(0x7f)));
+        return _mm_add_epi32(i, _mm_set1_epi32(0x80));
+    } else if constexpr (Format == HcaWaveFormat::S16) {
+        return _mm_cvttps_epi32(_mm_mul_ps(f, _mm_set1_ps(0x7fff)));
+    } else if constexpr (Format == HcaWaveFormat::S24) {
+        return _mm_cvttps_epi32(_mm_mul_ps(f, _mm_set1_ps(0x7fffff)));
+    } else if constexpr (Format == HcaWaveFormat::S32) {
+        const auto scale = _mm_set1_pd(0x7fffffff);
+        const auto lo    = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(f), scale));
+        const auto hi    = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(f, f)), scale));
+        return _mm_unpacklo_epi64(lo, hi);
+    } else {
+        return _mm_castps_si128(f);
+    }
+}
+
+// Writes 8 consecutive samples: 4 from a, then 4 from b.
+template<HcaWaveFormat Format>
+ACB_TARGET("sse2")
+static inline void StoreSamplesSse2(std::uint8_t *buffer, __m128i a, __m128i b) {
+    static_assert(Format != HcaWaveFormat::S24);
+    if constexpr (Format == HcaWaveFormat::U8) {
+        const auto mask = _mm_set1_epi32(0xff);
+        auto packed     = _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+        packed          = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(buffer), packed);
+    } else if constexpr (Format == HcaWaveFormat::S16) {
+        // Sign-extend the low 16 bits so that saturation in packs never kicks in.
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer), _mm_packs_epi32(a, b));
+    } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer + 0x10), b);
+    }
+}
+
+template<HcaWaveFormat Format, std::uint32_t Channels>
+ACB_TARGET("sse2")
+static void WriteBlockSse2(
+    const float *const *channelWaves, std::uint32_t channelCount, std::uint32_t frameCount,
+    float volume, std::uint8_t *buffer
+) {
+    if constexpr (Channels != 0) {
+        channelCount = Channels;
+    }
+    constexpr auto sampleSize = SampleSize<Format>;
+    const auto v              = _mm_set1_ps(volume);
+
+    if constexpr (Format != HcaWaveFormat::S24) {
+        if constexpr (Channels == 1) {
+            const auto wave = channelWaves[0];
+            for (std::uint32_t i = 0; i < frameCount; i += 8) {
+                const auto a = QuantizeSse2<Format>(_mm_loadu_ps(wave + i), v);
+                const auto b = QuantizeSse2<Format>(_mm_loadu_ps(wave + i + 4), v);
+                StoreSamplesSse2<Format>(buffer + i * sampleSize, a, b);
+            }
+            return;
+        }
+        if constexpr (Channels == 2) {
+            const auto left  = channelWaves[0];
+            const auto right = channelWaves[1];
+            for (std::uint32_t i = 0; i < frameCount; i += 4) {
+                const auto l = QuantizeSse2<Format>(_mm_loadu_ps(left + i), v);
+                const auto r = QuantizeSse2<Format>(_mm_loadu_ps(right + i), v);
+                StoreSamplesSse2<Format>(
+                    buffer + i * 2 * sampleSize, _mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)
+                );
+            }
+            return;
+        }
+    }
+
+    // Other layouts: convert 4 frames of each channel, then scatter the samples.
+    alignas(16) std::array<std::int32_t, 4> lanes = {};
+    const auto stride                             = channelCount * sampleSize;
+    for (std::uint32_t i = 0; i < frameCount; i += 4) {
+        auto frame = buffer + i * stride;
+        for (std::uint32_t k = 0; k < channelCount; ++k, frame += sampleSize) {
+            const auto q = QuantizeSse2<Format>(_mm_loadu_ps(channelWaves[k] + i), v);
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes.data()), q);
+            for (std::uint32_t j = 0; j < 4; ++j) {
+                std::memcpy(frame + j * stride, &lanes[j], sampleSize);
+            }
+        }
+    }
+}
+
+// AVX2 kernels: 8 samples per vector.
+
+template<HcaWaveFormat Format>
+ACB_TARGET("avx2")
+static inline auto QuantizeAvx2(__m256 wave, __m256 volume) -> __m256i {
+    auto f = _mm256_mul_ps(wave, volume);
+    f      = _mm256_min_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(_mm256_set1_ps(-1.0f), f));
+    if constexpr (Format == HcaWaveFormat::U8) {
+        const auto i = _mm256_cvttps_epi32(_mm256_mul_ps(f, _mm256_set1_ps(0x7f)));
+        return _mm256_add_epi32(i, _mm256_set1_epi32(0x80));
+    } else if constexpr (Format == HcaWaveFormat::S16) {
+        return _mm256_cvttps_epi32(_mm256_mul_ps(f, _mm256_set1_ps(0x7fff)));
+    } else if constexpr (Format == HcaWaveFormat::S24) {
+        return _mm256_cvttps_epi32(_mm256_mul_ps(f, _mm256_set1_ps(0x7fffff)));
+    } else if constexpr (Format == HcaWaveFormat::S32) {
+        const auto scale = _mm256_set1_pd(0x7fffffff);
+        const auto lo =
+            _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(f)), scale));
+        const auto hi =
+            _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)), scale));
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    } else {
+        return _mm256_castps_si256(f);
+    }
+}
+
+// Writes 16 consecutive samples: 8 from a, then 8 from b.
+template<HcaWaveFormat Format>
+ACB_TARGET("avx2")
+static inline void StoreSamplesAvx2(std::uint8_t *buffer, __m256i a, __m256i b) {
+    static_assert(Format != HcaWaveFormat::S24);
+    if constexpr (Format == HcaWaveFormat::U8) {
+        const auto mask = _mm256_set1_epi32(0xff);
+        // Packing works within 128-bit lanes, so restore the sample order after each step.
+        auto packed = _mm256_packs_epi32(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+        packed      = _mm256_permute4x64_epi64(packed, 0xd8);
+        packed      = _mm256_packus_epi16(packed, packed);
+        packed      = _mm256_permute4x64_epi64(packed, 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer), _mm256_castsi256_si128(packed));
+    } else if constexpr (Format == HcaWaveFormat::S16) {
+        a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+        b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+        const auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer), packed);
+    } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer), a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer + 0x20), b);
+    }
+}
+
+template<HcaWaveFormat Format, std::uint32_t Channels>
+ACB_TARGET("avx2")
+static void WriteBlockAvx2(
+    const float *const *channelWaves, std::uint32_t channelCount, std::uint32_t frameCount,
+    float volume, std::uint8_t *buffer
+) {
+    if constexpr (Channels != 0) {
+        channelCount = Channels;
+    }
+    constexpr auto sampleSize = SampleSize<Format>;
+    const auto v              = _mm256_set1_ps(volume);
+
+    if constexpr (Format != HcaWaveFormat::S24) {
+        if constexpr (Channels == 1) {
+            const auto wave = channelWaves[0];
+            for (std::uint32_t i = 0; i < frameCount; i += 16) {
+                const auto a = QuantizeAvx2<Format>(_mm256_loadu_ps(wave + i), v);
+                const auto b = QuantizeAvx2<Format>(_mm256_loadu_ps(wave + i + 8), v);
+                StoreSamplesAvx2<Format>(buffer + i * sampleSize, a, b);
+            }
+            return;
+        }
+        if constexpr (Channels == 2) {
+            const auto left  = channelWaves[0];
+            const auto right = channelWaves[1];
+            for (std::uint32_t i = 0; i < frameCount; i += 8) {
+                const auto l  = QuantizeAvx2<Format>(_mm256_loadu_ps(left + i), v);
+                const auto r  = QuantizeAvx2<Format>(_mm256_loadu_ps(right + i), v);
+                const auto lo = _mm256_unpacklo_epi32(l, r);
+                const auto hi = _mm256_unpackhi_epi32(l, r);
+                StoreSamplesAvx2<Format>(
+                    buffer + i * 2 * sampleSize,
+                    _mm256_permute2x128_si256(lo, hi, 0x20),
+                    _mm256_permute2x128_si256(lo, hi, 0x31)
+                );
+            }
+            return;
+        }
+    }
+
+    alignas(32) std::array<std::int32_t, 8> lanes = {};
+    const auto stride                             = channelCount * sampleSize;
+    for (std::uint32_t i = 0; i < frameCount; i += 8) {
+        auto frame = buffer + i * stride;
+        for (std::uint32_t k = 0; k < channelCount; ++k, frame += sampleSize) {
+            const auto q = QuantizeAvx2<Format>(_mm256_loadu_ps(channelWaves[k] + i), v);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes.data()), q);
+            for (std::uint32_t j = 0; j < 8; ++j) {
+                std::memcpy(frame + j * stride, &lanes[j], sampleSize);
+            }
+        }
+    }
+}
+
+#endif // ACB_ARCH_X86
+
+template<HcaWaveFormat Format, std::uint32_t Channels>
+static auto SelectWriteFunc() -> HcaWaveWriteFunc {
+#ifdef ACB_ARCH_X86
+    if (CCpuFeatures::HasAvx2()) {
+        return WriteBlockAvx2<Format, Channels>;
+    }
+    if (CCpuFeatures::HasSse2()) {
+        return WriteBlockSse2<Format, Channels>;
+    }
+#endif
+    return WriteBlockScalar<Format, Channels>;
+}
+
+template<HcaWaveFormat Format>
+static auto SelectWriteFunc(std::uint32_t channelCount) -> HcaWaveWriteFunc {
+    switch (channelCount) {
+    case 1:
+        return SelectWriteFunc<Format, 1>();
+    case 2:
+        return SelectWriteFunc<Format, 2>();
+    default:
+        return SelectWriteFunc<Format, 0>();
+    }
+}
+
+auto CHcaWaveWriter::GetFormat(HcaDecodeFunc decodeFunc) -> HcaWaveFormat {
+    if (decodeFunc == CDefaultWaveGenerator::Decode8BitU) {
+        return HcaWaveFormat::U8;
+    }
+    if (decodeFunc == CDefaultWaveGenerator::Decode16BitS) {
+        return HcaWaveFormat::S16;
+    }
+    if (decodeFunc == CDefaultWaveGenerator::Decode24BitS) {
+        return HcaWaveFormat::S24;
+    }
+    if (decodeFunc == CDefaultWaveGenerator::Decode32BitS) {
+        return HcaWaveFormat::S32;
+    }
+    if (decodeFunc == CDefaultWaveGenerator::DecodeFloat) {
+        return HcaWaveFormat::Float;
+    }
+    return HcaWaveFormat::Default;
+}
+
+auto CHcaWaveWriter::GetSampleSize(HcaWaveFormat format) -> std::uint32_t {
+    switch (format) {
+    case HcaWaveFormat::U8:
+        return SampleSize<HcaWaveFormat::U8>;
+    case HcaWaveFormat::S16:
+        return SampleSize<HcaWaveFormat::S16>;
+    case HcaWaveFormat::S24:
+        return SampleSize<HcaWaveFormat::S24>;
+    case HcaWaveFormat::S32:
+        return SampleSize<HcaWaveFormat::S32>;
+    case HcaWaveFormat::Float:
+        return SampleSize<HcaWaveFormat::Float>;
+    default:
+        return 0;
+    }
+}
+
+auto CHcaWaveWriter::GetWriteFunc(HcaWaveFormat format, std::uint32_t channelCount)
+    -> HcaWaveWriteFunc {
+    switch (format) {
+    case HcaWaveFormat::U8:
+        return SelectWriteFunc<HcaWaveFormat::U8>(channelCount);
+    case HcaWaveFormat::S16:
+        return SelectWriteFunc<HcaWaveFormat::S16>(channelCount);
+    case HcaWaveFormat::S24:
+        return SelectWriteFunc<HcaWaveFormat::S24>(channelCount);
+    case HcaWaveFormat::S32:
+        return SelectWriteFunc<HcaWaveFormat::S32>(channelCount);
+    case HcaWaveFormat::Float:
+        return SelectWriteFunc<HcaWaveFormat::Float>(channelCount);
+    default:
+        return nullptr;
+    }
+}
+
+ACB_NS_END
@@ -0,0 +1,66 @@
+#ifndef ACB_KAWASHIMA_HCA_CHCAWAVEWRITER_H_
+#define ACB_KAWASHIMA_HCA_CHCAWAVEWRITER_H_
+
+#include <cstdint>
+
+#include "acb_cdata.h"
+#include "acb_enum.h"
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+ACB_NS_BEGIN
+
+/**
+ * Writes one decoded block as interleaved wave samples.
+ * @param channelWaves Decoded waves of each channel, frameCount samples each.
+ * @param channelCount Number of channels.
+ * @param frameCount Number of samples of each channel: BlockFrameCount, or half of it at half rate.
+ * It must be a multiple of 16.
+ * @param volume Volume factor applied before clamping the samples to [-1, 1].
+ * @param buffer Destination buffer.
+ */
+using HcaWaveWriteFunc = void (*)(
+    const float *const *channelWaves, std::uint32_t channelCount, std::uint32_t frameCount,
+    float volume, std::uint8_t *buffer
+);
+
+/**
+ * Block converters from decoded float waves to interleaved wave samples.
+ * @remarks The output is identical to calling the matching CDefaultWaveGenerator function once per
+ * sample. Converters are instantiated per sample format, with dedicated instances for mono and
+ * stereo. SSE2 and AVX2 kernels are selected at runtime when the CPU supports them.
+ */
+class CHcaWaveWriter final {
+
+public:
+    static constexpr std::uint32_t BlockFrameCount = 0x400;
+
+    /**
+     * Finds the sample format written by a per-sample decode function.
+     * @param decodeFunc The per-sample decode function.
+     * @return The sample format, or HcaWaveFormat::Default if decodeFunc is not one of the
+     * CDefaultWaveGenerator functions.
+     */
+    static auto GetFormat(HcaDecodeFunc decodeFunc) -> HcaWaveFormat;
+
+    /**
+     * Gets the size of one sample.
+     * @param format The sample format. It must not be HcaWaveFormat::Default.
+     * @return The size in bytes, or 0 for an unknown format.
+     */
+    static auto GetSampleSize(HcaWaveFormat format) -> std::uint32_t;
+
+    /**
+     * Gets the block converter for a sample format and channel count.
+     * @param format The sample format.
+     * @param channelCount Number of channels. The converter must only be called with this count.
+     * @return The block converter, or nullptr for HcaWaveFormat::Default or an unknown format.
+     */
+    static auto GetWriteFunc(HcaWaveFormat format, std::uint32_t channelCount) -> HcaWaveWriteFunc;
+
+    PURE_STATIC(CHcaWaveWriter);
+};
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CHCAWAVEWRITER_H_
@@ -0,0 +1,90 @@
+#ifndef ACB_KAWASHIMA_HCA_CTASKRUNNER_H_
+#define ACB_KAWASHIMA_HCA_CTASKRUNNER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+
+ACB_NS_BEGIN
+
+/**
+ * Runs independent tasks on a few threads, which take the tasks in order until none is left.
+ */
+class CTaskRunner final {
+
+public:
+    /**
+     * Runs tasks on up to threadCount threads, the calling thread included.
+     * @remarks If a thread cannot be created, the threads already running and the calling thread
+     * share the remaining tasks. After a task throws, no new task is started, and the exception is
+     * rethrown once every thread has finished.
+     * @param taskCount Number of tasks.
+     * @param threadCount Maximum number of threads, or 0 for one per hardware thread.
+     * @param taskFunc Called as taskFunc(taskIndex, cancelled). cancelled is set once a task has
+     * thrown, so that long tasks can stop early.
+     */
+    template<typename TaskFunc>
+    static void Run(std::size_t taskCount, std::uint32_t threadCount, const TaskFunc &taskFunc);
+
+    PURE_STATIC(CTaskRunner);
+};
+
+template<typename TaskFunc>
+void CTaskRunner::Run(std::size_t taskCount, std::uint32_t threadCount, const TaskFunc &taskFunc) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    const auto workerCount =
+        static_cast<std::uint32_t>(std::min(static_cast<std::size_t>(threadCount), taskCount));
+    if (workerCount == 0) {
+        return;
+    }
+
+    std::atomic<std::size_t> nextTask = 0;
+    std::atomic<bool> cancelled       = false;
+    std::vector<std::exception_ptr> errors(workerCount);
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+
+    auto runWorker = [&](std::uint32_t worker) {
+        try {
+            for (auto task = nextTask++; task < taskCount && !cancelled; task = nextTask++) {
+                taskFunc(task, cancelled);
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+            cancelled      = true;
+        }
+    };
+
+    // The calling thread runs the last worker itself.
+    for (std::uint32_t worker = 0; worker + 1 < workerCount; ++worker) {
+        try {
+            threads.emplace_back(runWorker, worker);
+        } catch (std::system_error &) {
+            break;
+        }
+    }
+    runWorker(workerCount - 1);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+ACB_NS_END
+
+#endif // ACB_KAWASHIMA_HCA_CTASKRUNNER_H_
@@ -0,0 +1,189 @@
+#include "acb_env_platform.h"
+
+#ifdef ACB_OS_WINDOWS
+
+#include <windows.h>
+
+#elifdef ACB_OS_UNIX
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "acb_env.h"
+#include "acb_env_ns.h"
+#include "takamori/CMemoryMappedFile.h"
+#include "takamori/exceptions/CArgumentException.h"
+#include "takamori/exceptions/CException.h"
+
+ACB_NS_BEGIN
+
+CMemoryMappedFile::CMemoryMappedFile(const std::string &fileName)
+    : _view(nullptr), _viewSize(0), _data(nullptr), _size(0), _file(-1), _mapping(nullptr) {
+    Map(fileName, 0, 0, TRUE);
+}
+
+CMemoryMappedFile::CMemoryMappedFile(
+    const std::string &fileName, std::uint64_t offset, std::uint64_t size
+)
+    : _view(nullptr), _viewSize(0), _data(nullptr), _size(0), _file(-1), _mapping(nullptr) {
+    Map(fileName, offset, size, FALSE);
+}
+
+CMemoryMappedFile::~CMemoryMappedFile() {
+    Unmap();
+}
+
+auto CMemoryMappedFile::GetData() -> std::uint8_t * {
+    return _data;
+}
+
+auto CMemoryMappedFile::GetSize() const -> std::uint64_t {
+    return _size;
+}
+
+void CMemoryMappedFile::Map(
+    const std::string &fileName, std::uint64_t offset, std::uint64_t size, bool_t whole
+) {
+#define MAP_FAILED_WITH(what)                                                           \
+    do {                                                                                \
+        Unmap();                                                                        \
+        throw CException(OpResult::InvalidHandle, std::string(what) + ": " + fileName); \
+    } while (0)
+
+    std::uint64_t fileSize;
+    std::uint64_t granularity;
+#ifdef ACB_OS_WINDOWS
+    const auto file = CreateFileA(
+        fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        MAP_FAILED_WITH("Cannot open file");
+    }
+    _file = reinterpret_cast<std::intptr_t>(file);
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length)) {
+        MAP_FAILED_WITH("Cannot get file size");
+    }
+    fileSize = static_cast<std::uint64_t>(length.QuadPart);
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    granularity = systemInfo.dwAllocationGranularity;
+#elifdef ACB_OS_UNIX
+    const auto fd = ::open(fileName.c_str(), O_RDWR);
+    if (fd < 0) {
+        MAP_FAILED_WITH("Cannot open file");
+    }
+    _file = fd;
+
+    struct stat fileStat = {};
+    if (::fstat(fd, &fileStat) != 0) {
+        MAP_FAILED_WITH("Cannot get file size");
+    }
+    fileSize    = static_cast<std::uint64_t>(fileStat.st_size);
+    granularity = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+#endif
+
+    if (whole) {
+        offset = 0;
+        size   = fileSize;
+    }
+    if (offset > fileSize || size > fileSize - offset) {
+        Unmap();
+        throw CArgumentException("CMemoryMappedFile::CMemoryMappedFile");
+    }
+    if (size == 0) {
+        // Nothing to map. Empty views are not allowed.
+        return;
+    }
+
+    const auto viewOffset = offset - offset % granularity;
+    const auto viewSize   = size + (offset - viewOffset);
+    if (viewSize > std::numeric_limits<std::size_t>::max()) {
+        MAP_FAILED_WITH("Range too large to map");
+    }
+
+#ifdef ACB_OS_WINDOWS
+    _mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (!_mapping) {
+        MAP_FAILED_WITH("Cannot map file");
+    }
+    const auto view = MapViewOfFile(
+        _mapping, FILE_MAP_WRITE, static_cast<DWORD>(viewOffset >> 32u),
+        static_cast<DWORD>(viewOffset & 0xffffffffu), static_cast<SIZE_T>(viewSize)
+    );
+    if (!view) {
+        MAP_FAILED_WITH("Cannot map file");
+    }
+#elifdef ACB_OS_UNIX
+    const auto view = ::mmap(
+        nullptr, static_cast<std::size_t>(viewSize), PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+        static_cast<off_t>(viewOffset)
+    );
+    if (view == MAP_FAILED) {
+        MAP_FAILED_WITH("Cannot map file");
+    }
+#endif
+
+    _view     = static_cast<std::uint8_t *>(view);
+    _viewSize = viewSize;
+    _data     = _view + (offset - viewOffset);
+    _size     = size;
+#undef MAP_FAILED_WITH
+}
+
+void CMemoryMappedFile::Flush() {
+    if (!_view) {
+        return;
+    }
+#ifdef ACB_OS_WINDOWS
+    if (!FlushViewOfFile(_view, static_cast<SIZE_T>(_viewSize)) ||
+        !FlushFileBuffers(reinterpret_cast<HANDLE>(_file))) {
+        throw CException(OpResult::InvalidHandle, "Cannot flush mapped file");
+    }
+#elifdef ACB_OS_UNIX
+    if (::msync(_view, static_cast<std::size_t>(_viewSize), MS_SYNC) != 0) {
+        throw CException(OpResult::InvalidHandle, "Cannot flush mapped file");
+    }
+#endif
+}
+
+void CMemoryMappedFile::Unmap() {
+#ifdef ACB_OS_WINDOWS
+    if (_view) {
+        UnmapViewOfFile(_view);
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+    }
+    if (_file != -1) {
+        CloseHandle(reinterpret_cast<HANDLE>(_file));
+    }
+#elifdef ACB_OS_UNIX
+    if (_view) {
+        ::munmap(_view, static_cast<std::size_t>(_viewSize));
+    }
+    if (_file != -1) {
+        ::close(static_cast<int>(_file));
+    }
+#endif
+    _view     = nullptr;
+    _viewSize = 0;
+    _data     = nullptr;
+    _size     = 0;
+    _file     = -1;
+    _mapping  = nullptr;
+}
+
+ACB_NS_END